@@ -0,0 +1,443 @@
+// Project-2 - Luca Vicaria - PHYS30762
+// This file is the microbenchmark suite for the particle simulation project.
+// Each benchmark is run for a fixed minimum time and reports the mean time, heap allocations and heap bytes per
+// operation. Allocations are counted by replacing the global operator new. Build with "make benchmark".
+//
+// Usage: ./benchmark [--json] [--filter <text>] [--min-time <seconds>]
+// Last modified 16/10/2026
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <new>
+#include <string>
+#include <vector>
+
+#include "particle.hpp"
+#include "leptons.hpp"
+#include "quarks.hpp"
+#include "bosons.hpp"
+#include "four_momentum.hpp"
+#include "four_momentum_batch.hpp"
+#include "calorimeter.hpp"
+#include "isolation.hpp"
+#include "jet_clustering.hpp"
+#include "decay_modes.hpp"
+#include "decay_validator.hpp"
+#include "decay_graph.hpp"
+#include "particle_catalogue.hpp"
+#include "pdg_lookup.hpp"
+
+// Global allocation counters. Relaxed atomics, since only the totals before and after a run matter.
+namespace allocation_counter {
+	std::atomic<std::uint64_t> count{0};
+	std::atomic<std::uint64_t> bytes{0};
+
+	inline void* allocate(std::size_t size) {
+		count.fetch_add(1, std::memory_order_relaxed);
+		bytes.fetch_add(size, std::memory_order_relaxed);
+		if(void* memory = std::malloc(size == 0 ? 1 : size))
+			return memory;
+		throw std::bad_alloc();
+	}
+
+	inline void* allocateAligned(std::size_t size, std::align_val_t alignment) {
+		count.fetch_add(1, std::memory_order_relaxed);
+		bytes.fetch_add(size, std::memory_order_relaxed);
+		const std::size_t align = static_cast<std::size_t>(alignment);
+		// aligned_alloc requires the size to be a multiple of the alignment
+		if(void* memory = std::aligned_alloc(align, (std::max<std::size_t>(size, 1) + align - 1) / align * align))
+			return memory;
+		throw std::bad_alloc();
+	}
+}
+
+void* operator new(std::size_t size) { return allocation_counter::allocate(size); }
+void* operator new[](std::size_t size) { return allocation_counter::allocate(size); }
+void* operator new(std::size_t size, std::align_val_t alignment) { return allocation_counter::allocateAligned(size, alignment); }
+void* operator new[](std::size_t size, std::align_val_t alignment) { return allocation_counter::allocateAligned(size, alignment); }
+void operator delete(void* memory) noexcept { std::free(memory); }
+void operator delete[](void* memory) noexcept { std::free(memory); }
+void operator delete(void* memory, std::size_t) noexcept { std::free(memory); }
+void operator delete[](void* memory, std::size_t) noexcept { std::free(memory); }
+void operator delete(void* memory, std::align_val_t) noexcept { std::free(memory); }
+void operator delete[](void* memory, std::align_val_t) noexcept { std::free(memory); }
+void operator delete(void* memory, std::size_t, std::align_val_t) noexcept { std::free(memory); }
+void operator delete[](void* memory, std::size_t, std::align_val_t) noexcept { std::free(memory); }
+
+// Stop the optimiser from discarding a result that is otherwise unused
+template <typename T>
+inline void doNotOptimize(const T& value) {
+#if defined(__GNUC__)
+	asm volatile("" : : "r,m"(value) : "memory");
+#else
+	static volatile const void* sink;
+	sink = &value;
+#endif
+}
+
+struct BenchmarkResult {
+	std::string name;
+	std::uint64_t iterations;
+	double nsPerOp;
+	double allocsPerOp;
+	double bytesPerOp;
+};
+
+class BenchmarkRunner {
+private:
+	double m_minSeconds;
+	std::string m_filter;
+	std::vector<BenchmarkResult> m_results;
+
+	// Time one batch of iterations, returning seconds
+	static double timeBatch(const std::function<void()>& body, std::uint64_t iterations) {
+		auto start = std::chrono::steady_clock::now();
+		for(std::uint64_t i = 0; i < iterations; ++i)
+			body();
+		return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	}
+
+public:
+	BenchmarkRunner(double minSeconds, std::string filter) : m_minSeconds(minSeconds), m_filter(std::move(filter)) {}
+
+	// Run body repeatedly, growing the iteration count until a batch takes at least the minimum time
+	void run(const std::string& name, const std::function<void()>& body) {
+		if(!m_filter.empty() && name.find(m_filter) == std::string::npos)
+			return;
+
+		body(); // Warm up caches and any lazily built tables
+
+		std::uint64_t iterations = 1;
+		while(true) {
+			const std::uint64_t allocsBefore = allocation_counter::count.load(std::memory_order_relaxed);
+			const std::uint64_t bytesBefore = allocation_counter::bytes.load(std::memory_order_relaxed);
+			const double seconds = timeBatch(body, iterations);
+			const std::uint64_t allocs = allocation_counter::count.load(std::memory_order_relaxed) - allocsBefore;
+			const std::uint64_t bytes = allocation_counter::bytes.load(std::memory_order_relaxed) - bytesBefore;
+
+			if(seconds >= m_minSeconds || iterations >= (1ull << 40)) {
+				const double n = static_cast<double>(iterations);
+				m_results.push_back({name, iterations, seconds * 1e9 / n, allocs / n, bytes / n});
+				return;
+			}
+			// Aim slightly past the minimum time, but never grow by more than 10x at once
+			const double scale = seconds > 0.0 ? 1.4 * m_minSeconds / seconds : 10.0;
+			iterations = std::max<std::uint64_t>(iterations + 1, static_cast<std::uint64_t>(iterations * std::min(scale, 10.0)));
+		}
+	}
+
+	void printTable(std::FILE* out) const {
+		std::fprintf(out, "%-44s %14s %12s %12s %12s\n", "benchmark", "iterations", "ns/op", "allocs/op", "bytes/op");
+		for(const auto& result : m_results)
+			std::fprintf(out, "%-44s %14llu %12.1f %12.2f %12.1f\n", result.name.c_str(), static_cast<unsigned long long>(result.iterations),
+			             result.nsPerOp, result.allocsPerOp, result.bytesPerOp);
+	}
+
+	// One JSON object with a "benchmarks" array, so results can be diffed between releases
+	void printJson(std::FILE* out) const {
+		std::fprintf(out, "{\n  \"benchmarks\": [\n");
+		for(std::size_t i = 0; i < m_results.size(); ++i) {
+			const auto& result = m_results[i];
+			std::fprintf(out, "    {\"name\": \"%s\", \"iterations\": %llu, \"ns_per_op\": %.3f, \"allocs_per_op\": %.3f, \"bytes_per_op\": %.3f}%s\n",
+			             result.name.c_str(), static_cast<unsigned long long>(result.iterations), result.nsPerOp, result.allocsPerOp,
+			             result.bytesPerOp, i + 1 < m_results.size() ? "," : "");
+		}
+		std::fprintf(out, "  ]\n}\n");
+	}
+};
+
+// One of each particle family, as in the interactive catalogue
+ParticleCatalogue buildCatalogue() {
+	ParticleCatalogue catalogue;
+	catalogue.emplace<Electron>("electron", FourMomentum(0.511, 0, 0, 0));
+	catalogue.emplace<Electron>("anti-electron", FourMomentum(0.511, 0, 0, 0), true);
+	catalogue.emplace<Muon>("muon", FourMomentum(105.66, 0, 0, 0));
+	catalogue.emplace<Muon>("anti-muon", FourMomentum(105.66, 0, 0, 0), true);
+	catalogue.emplace<Tau>("tau", FourMomentum(1776.8, 0, 0, 0));
+	catalogue.emplace<Neutrino>("electron neutrino", NeutrinoType::ElectronNeutrino, FourMomentum(0, 0, 0, 0));
+	catalogue.emplace<Neutrino>("muon neutrino", NeutrinoType::MuonNeutrino, FourMomentum(0, 0, 0, 0));
+	catalogue.emplace<Neutrino>("tau neutrino", NeutrinoType::TauNeutrino, FourMomentum(0, 0, 0, 0));
+	catalogue.emplace<Quark>("upquark", QuarkType::UpQuark, ColourCharge::Red, FourMomentum(2.2, 0, 0, 0));
+	catalogue.emplace<Quark>("downquark", QuarkType::DownQuark, ColourCharge::Blue, FourMomentum(4.7, 0, 0, 0));
+	catalogue.emplace<Quark>("topquark", QuarkType::TopQuark, ColourCharge::Blue, FourMomentum(173100, 0, 0, 0));
+	catalogue.emplace<Photon>("photon", FourMomentum(0, 0, 0, 0));
+	catalogue.emplace<WBoson>("Wboson", FourMomentum(80360, 0, 0, 0));
+	catalogue.emplace<ZBoson>("Zboson", FourMomentum(91190, 0, 0, 0));
+	catalogue.emplace<Gluon>("gluon", FourMomentum(0, 0, 0, 0), ColourCharge::Red, ColourCharge::AntiRed);
+	catalogue.emplace<HiggsBoson>("higgs boson", FourMomentum(125110, 0, 0, 0));
+	return catalogue;
+}
+
+void runConstruction(BenchmarkRunner& runner) {
+	auto momentum = FourMomentum(1000, 10, 20, 30);
+	runner.run("construct/Electron", [&] { Electron particle(momentum); doNotOptimize(particle); });
+	runner.run("construct/Muon", [&] { Muon particle(momentum); doNotOptimize(particle); });
+	runner.run("construct/Tau", [&] { Tau particle(momentum); doNotOptimize(particle); });
+	runner.run("construct/Neutrino", [&] { Neutrino particle(NeutrinoType::MuonNeutrino, momentum); doNotOptimize(particle); });
+	runner.run("construct/Quark", [&] { Quark particle(QuarkType::CharmQuark, ColourCharge::Green, momentum); doNotOptimize(particle); });
+	runner.run("construct/Photon", [&] { Photon particle(momentum); doNotOptimize(particle); });
+	runner.run("construct/WBoson", [&] { WBoson particle(momentum); doNotOptimize(particle); });
+	runner.run("construct/ZBoson", [&] { ZBoson particle(momentum); doNotOptimize(particle); });
+	runner.run("construct/Gluon", [&] { Gluon particle(momentum, ColourCharge::Red, ColourCharge::AntiBlue); doNotOptimize(particle); });
+	runner.run("construct/HiggsBoson", [&] { HiggsBoson particle(momentum); doNotOptimize(particle); });
+}
+
+void runFormatting(BenchmarkRunner& runner, const ParticleCatalogue& catalogue) {
+	const Particle& electron = catalogue.at("electron");
+	const Particle& quark = catalogue.at("upquark");
+	runner.run("getInfo/Electron", [&] { std::string info = electron.getInfo(); doNotOptimize(info); });
+	runner.run("getInfo/Quark", [&] { std::string info = quark.getInfo(); doNotOptimize(info); });
+
+	// The streaming path with a reused buffer, which should not allocate
+	std::string buffer;
+	runner.run("format_to/Electron/text", [&] { buffer.clear(); electron.format_to(buffer); doNotOptimize(buffer); });
+	runner.run("format_to/Electron/json", [&] { buffer.clear(); electron.format_to(buffer, FormatStyle::Json); doNotOptimize(buffer); });
+}
+
+void runAntiParticles(BenchmarkRunner& runner, const ParticleCatalogue& catalogue) {
+	const Particle& muon = catalogue.at("muon");
+	const Particle& quark = catalogue.at("upquark");
+	const Particle& w = catalogue.at("Wboson");
+	runner.run("getAntiParticle/Muon", [&] { auto anti = muon.getAntiParticle(); doNotOptimize(anti); });
+	runner.run("getAntiParticle/Quark", [&] { auto anti = quark.getAntiParticle(); doNotOptimize(anti); });
+	runner.run("getAntiParticle/WBoson", [&] { auto anti = w.getAntiParticle(); doNotOptimize(anti); });
+}
+
+void runConservation(BenchmarkRunner& runner) {
+	// Valid decays, so the checks run to completion without writing to std::cerr
+	std::vector<std::shared_ptr<Particle>> tauDecay = {
+		std::make_shared<Muon>(FourMomentum(105.66, 0, 0, 0)),
+		std::make_shared<Neutrino>(NeutrinoType::MuonNeutrino, FourMomentum(0, 0, 0, 0), true),
+		std::make_shared<Neutrino>(NeutrinoType::TauNeutrino, FourMomentum(0, 0, 0, 0))};
+	std::vector<std::shared_ptr<Particle>> zDecay = {
+		std::make_shared<Electron>(FourMomentum(45595, 0, 0, 45595)),
+		std::make_shared<Electron>(FourMomentum(45595, 0, 0, -45595), true)};
+
+	Tau tau(FourMomentum(1776.8, 0, 0, 0));
+	ZBoson z(FourMomentum(91190, 0, 0, 0));
+	runner.run("conservation/Tau::setDecayParticles", [&] { tau.setDecayParticles(tauDecay); doNotOptimize(tau); });
+	runner.run("conservation/ZBoson::setDecayParticles", [&] { z.setDecayParticles(zDecay); doNotOptimize(z); });
+
+	// Looking a final state up in the decay mode registry
+	const std::array<int, 3> tauDaughterIds{16, -2, 1};
+	runner.run("conservation/DecayModeRegistry::find", [&] {
+		doNotOptimize(tauDaughterIds);
+		int mode = DecayModeRegistry::find(15, tauDaughterIds.data(), tauDaughterIds.size());
+		doNotOptimize(mode);
+	});
+
+	// Drawing decay channels by branching ratio, one at a time and in batches
+	PhiloxEngine stream(42, 0);
+	const DecayModeSampler& zModes = DecayModeSampler::of(23);
+	std::vector<std::uint32_t> channels(1024);
+	runner.run("sampling/DecayModeSampler::sample[Z]", [&] { std::uint32_t channel = zModes.sampleChannel(stream); doNotOptimize(channel); });
+	runner.run("sampling/DecayModeSampler::sample[Z, 1024]", [&] { zModes.sample(stream, channels.data(), channels.size()); doNotOptimize(channels); });
+
+	// The batch validator, per decay
+	constexpr std::size_t BATCH = 1024;
+	DecayBatch batch;
+	batch.reserve(BATCH);
+	for(std::size_t i = 0; i < BATCH; ++i)
+		batch.add(z, zDecay);
+	std::vector<std::uint8_t> violations(BATCH);
+	DecayValidator validator;
+	runner.run("conservation/DecayValidator::validate[1024]", [&] { validator.validate(batch, violations.data()); doNotOptimize(violations); });
+}
+
+// Sum of the final-state energies of a decay chain by recursion over the particle objects
+double finalStateEnergy(const Particle& particle) {
+	const auto& daughters = particle.getDecayParticles();
+	if(daughters.empty())
+		return particle.getFourMomentum().get_energy();
+	double total = 0.0;
+	for(const auto& daughter : daughters)
+		total += finalStateEnergy(*daughter);
+	return total;
+}
+
+void runDecayGraph(BenchmarkRunner& runner) {
+	// H -> ZZ -> 4 leptons
+	auto z1 = std::make_shared<ZBoson>(FourMomentum(91190, 0, 0, 0));
+	z1->setDecayParticles({std::make_shared<Muon>(FourMomentum(45595, 0, 0, 45595)),
+	                       std::make_shared<Muon>(FourMomentum(45595, 0, 0, -45595), true)});
+	auto z2 = std::make_shared<ZBoson>(FourMomentum(91190, 0, 0, 0));
+	z2->setDecayParticles({std::make_shared<Electron>(FourMomentum(45595, 0, 45595, 0)),
+	                       std::make_shared<Electron>(FourMomentum(45595, 0, -45595, 0), true)});
+	HiggsBoson higgs(FourMomentum(125110, 0, 0, 0));
+	higgs.setDecayParticles({z1, z2});
+
+	DecayGraph graph;
+	graph.add(higgs);
+	runner.run("decayChain/recursive final state[H->ZZ->4l]", [&] { double energy = finalStateEnergy(higgs); doNotOptimize(energy); });
+	runner.run("decayChain/DecayGraph::finalState[H->ZZ->4l]", [&] {
+		double energy = 0.0;
+		for(const DecayNode& node : graph.finalState())
+			energy += node.energy;
+		doNotOptimize(energy);
+	});
+	runner.run("decayChain/DecayGraph::add[H->ZZ->4l]", [&] { graph.clear(); graph.add(higgs); doNotOptimize(graph); });
+}
+
+void runFourMomentum(BenchmarkRunner& runner) {
+	FourMomentum momentum(1000, 100, 200, 300);
+	runner.run("FourMomentum::invariant_mass", [&] { doNotOptimize(momentum); double mass = momentum.invariant_mass(); doNotOptimize(mass); });
+
+	// Summing four-momenta: repeated operator+ over particles, and the column-wise batch sum
+	constexpr std::size_t COUNT = 1024;
+	std::vector<FourMomentum> momenta;
+	FourMomentumBatch batch;
+	batch.reserve(COUNT);
+	for(std::size_t i = 0; i < COUNT; ++i) {
+		momenta.emplace_back(1000.0 + i, 0.5 * i, -0.25 * i, 10.0);
+		batch.push_back(momenta.back());
+	}
+	runner.run("sumFourMomenta/operator+[1024]", [&] {
+		FourMomentum total;
+		for(const auto& p : momenta)
+			total = total + p;
+		doNotOptimize(total);
+	});
+	runner.run("sumFourMomenta/FourMomentumBatch::sum[1024]", [&] { FourMomentum total = batch.sum(0, batch.size()); doNotOptimize(total); });
+
+	// Rewriting all four components of an on-shell four-momentum: through the setters, which validate four times,
+	// and through set_components, which validates once
+	const double mass = 105.66, pz = 50.0, energy = std::sqrt(mass * mass + pz * pz);
+	FourMomentum muon(energy, 0.0, 0.0, pz);
+	muon.set_rest_mass(mass);
+	runner.run("validation/setters", [&] {
+		muon.set_energy(energy);
+		muon.set_px(0.0);
+		muon.set_py(0.0);
+		muon.set_pz(pz);
+		doNotOptimize(muon);
+	});
+	runner.run("validation/set_components", [&] { muon.set_components(energy, 0.0, 0.0, pz); doNotOptimize(muon); });
+
+	// Checking a batch against its rest masses in one pass
+	std::vector<double> restMasses = batch.invariant_masses();
+	restMasses[COUNT / 2] += 1.0;
+	std::vector<std::size_t> offShell;
+	runner.run("validation/FourMomentumBatch::find_off_shell[1024]", [&] {
+		offShell.clear();
+		batch.find_off_shell(restMasses.data(), offShell);
+		doNotOptimize(offShell);
+	});
+}
+
+void runCalorimeter(BenchmarkRunner& runner) {
+	// Showers spread over the barrel and both end caps, some outside the acceptance
+	constexpr std::size_t COUNT = 1024;
+	FourMomentumBatch batch;
+	batch.reserve(COUNT);
+	for(std::size_t i = 0; i < COUNT; ++i) {
+		const double pz = 40.0 * (static_cast<double>(i % 97) - 48.0);
+		const double px = 30.0 * std::cos(0.37 * i), py = 30.0 * std::sin(0.37 * i);
+		batch.push_back(FourMomentum(std::sqrt(px * px + py * py + pz * pz), px, py, pz));
+	}
+	Calorimeter calorimeter;
+	runner.run("calorimeter/deposit[1024]", [&] { calorimeter.deposit(batch, ShowerType::Electron); doNotOptimize(calorimeter); });
+	runner.run("calorimeter/ShowerProfile::fractions", [&] {
+		double fractions[8];
+		ShowerProfile::standard().fractions(5000.0, ShowerType::Photon, fractions);
+		doNotOptimize(fractions);
+	});
+}
+
+void runIsolation(BenchmarkRunner& runner) {
+	// 16 events of 400 particles spread over |eta| < 2.5, with every 50th particle a muon
+	constexpr std::size_t EVENTS = 16, PARTICLES = 400;
+	IsolationBatch batch;
+	batch.reserve(EVENTS, PARTICLES);
+	for(std::size_t event = 0; event < EVENTS; ++event) {
+		for(std::size_t i = 0; i < PARTICLES; ++i) {
+			const double angle = 0.61 * (event * PARTICLES + i);
+			const double pt = 5.0 + (i % 13), pz = pt * std::sinh(2.5 * std::sin(1.37 * angle));
+			const double px = pt * std::cos(angle), py = pt * std::sin(angle);
+			batch.add(FourMomentum(std::sqrt(pt * pt + pz * pz), px, py, pz), i % 50 == 0);
+		}
+		batch.endEvent();
+	}
+	MuonIsolation isolation;
+	std::vector<double> sums(batch.muons());
+	runner.run("isolation/MuonIsolation::coneSums[16x400]", [&] { isolation.coneSums(batch, sums.data()); doNotOptimize(sums); });
+}
+
+void runJets(BenchmarkRunner& runner) {
+	// One event of 500 particles: soft particles spread over |y| < 4 plus a few collimated sprays
+	constexpr std::size_t PARTICLES = 500;
+	FourMomentumBatch event;
+	event.reserve(PARTICLES);
+	for(std::size_t i = 0; i < PARTICLES; ++i) {
+		const double spray = i % 5 == 0 ? 0.2 : 4.0;
+		const double pt = i % 5 == 0 ? 40.0 + i % 17 : 1.0 + i % 7;
+		const double eta = spray * std::sin(0.77 * i), phi = i % 5 == 0 ? 0.5 * (i % 4) + 0.1 * std::cos(1.3 * i) : 2.39996 * i;
+		event.push_back(pt * std::cosh(eta), pt * std::cos(phi), pt * std::sin(phi), pt * std::sinh(eta));
+	}
+	const std::vector<std::uint32_t> offsets{0, static_cast<std::uint32_t>(PARTICLES)};
+	for(const auto& [name, algorithm] : {std::pair<const char*, JetAlgorithm>{"jets/anti-kT[500]", JetAlgorithm::AntiKt},
+	                                     {"jets/kT[500]", JetAlgorithm::Kt}, {"jets/Cambridge-Aachen[500]", JetAlgorithm::CambridgeAachen}}) {
+		JetDefinition definition;
+		definition.algorithm = algorithm;
+		JetClusterer clusterer(definition);
+		clusterer.cluster(event, offsets); // Size the scratch space before timing
+		runner.run(name, [&] { JetCollection jets = clusterer.cluster(event, offsets); doNotOptimize(jets); });
+	}
+}
+
+void runLookup(BenchmarkRunner& runner, const ParticleCatalogue& catalogue) {
+	const std::string name = "higgs boson";
+	const std::string alias = "positron";
+	runner.run("catalogue/find", [&] { const Particle* particle = catalogue.find(name); doNotOptimize(particle); });
+	runner.run("catalogue/resolve(alias)", [&] { const Particle* particle = catalogue.resolve(alias); doNotOptimize(particle); });
+	runner.run("catalogue/findPdgId", [&] { const Particle* particle = catalogue.findPdgId(-11); doNotOptimize(particle); });
+	runner.run("catalogue/massRange", [&] { std::size_t count = catalogue.countMassRange(1000, 100000); doNotOptimize(count); });
+	runner.run("PdgLookup::resolve", [&] { int id = PdgLookup::resolve(alias); doNotOptimize(id); });
+}
+
+int main(int argc, char* argv[]) {
+	bool json = false;
+	std::string filter;
+	double minSeconds = 0.2;
+	for(int i = 1; i < argc; ++i) {
+		const std::string argument = argv[i];
+		if(argument == "--json")
+			json = true;
+		else if(argument == "--filter" && i + 1 < argc)
+			filter = argv[++i];
+		else if(argument == "--min-time" && i + 1 < argc)
+			minSeconds = std::atof(argv[++i]);
+		else {
+			std::cerr<<"Usage: "<<argv[0]<<" [--json] [--filter <text>] [--min-time <seconds>]"<<std::endl;
+			return 1;
+		}
+	}
+
+	BenchmarkRunner runner(minSeconds, filter);
+	ParticleCatalogue catalogue = buildCatalogue();
+
+	runConstruction(runner);
+	runFormatting(runner, catalogue);
+	runAntiParticles(runner, catalogue);
+	runConservation(runner);
+	runDecayGraph(runner);
+	runFourMomentum(runner);
+	runCalorimeter(runner);
+	runIsolation(runner);
+	runJets(runner);
+	runLookup(runner, catalogue);
+
+	if(json)
+		runner.printJson(stdout);
+	else
+		runner.printTable(stdout);
+	return 0;
+}
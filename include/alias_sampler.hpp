@@ -0,0 +1,99 @@
+// Project-2 - Luca Vicaria - PHYS30762
+// This file defines a sampler for discrete distributions using Walker's alias method, built with Vose's algorithm.
+// Every outcome gets a column holding its own probability mass topped up by one other outcome, the alias, so a
+// draw is one uniform, one column lookup and one comparison, whatever the number of outcomes.
+// Last modified 16/10/2026
+
+#ifndef ALIAS_SAMPLER_HPP
+#define ALIAS_SAMPLER_HPP
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <vector>
+
+#include "random_service.hpp"
+
+class AliasSampler {
+private:
+	std::vector<double> m_threshold;    // Probability of keeping the column's own outcome rather than its alias
+	std::vector<std::uint32_t> m_alias;
+
+public:
+	AliasSampler() = default;
+
+	// Weights need not be normalised, but must be finite, non-negative and not all zero
+	AliasSampler(const double* weights, std::size_t n) : m_threshold(n), m_alias(n) {
+		if(n == 0 || n > UINT32_MAX)
+			throw std::invalid_argument("An alias sampler needs between 1 and 2^32 - 1 outcomes.");
+		double total = 0.0;
+		for(std::size_t i = 0; i < n; ++i) {
+			if(!(weights[i] >= 0.0) || std::isinf(weights[i]))
+				throw std::invalid_argument("Alias sampler weights must be finite and non-negative.");
+			total += weights[i];
+		}
+		if(!(total > 0.0))
+			throw std::invalid_argument("Alias sampler weights must not all be zero.");
+
+		// Scale so the mean column holds 1, then pair each under-full column with an over-full one
+		std::vector<std::uint32_t> small, large;
+		small.reserve(n);
+		large.reserve(n);
+		for(std::size_t i = 0; i < n; ++i) {
+			m_threshold[i] = weights[i] * static_cast<double>(n) / total;
+			m_alias[i] = static_cast<std::uint32_t>(i);
+			(m_threshold[i] < 1.0 ? small : large).push_back(static_cast<std::uint32_t>(i));
+		}
+		while(!small.empty() && !large.empty()) {
+			const std::uint32_t under = small.back();
+			small.pop_back();
+			const std::uint32_t over = large.back();
+			m_alias[under] = over;
+			m_threshold[over] -= 1.0 - m_threshold[under];
+			if(m_threshold[over] < 1.0) {
+				large.pop_back();
+				small.push_back(over);
+			}
+		}
+		// Whatever is left is full up to rounding error
+		for(std::uint32_t i : small)
+			m_threshold[i] = 1.0;
+		for(std::uint32_t i : large)
+			m_threshold[i] = 1.0;
+	}
+
+	explicit AliasSampler(const std::vector<double>& weights) : AliasSampler(weights.data(), weights.size()) {}
+
+	std::size_t size() const { return m_alias.size(); }
+	bool empty() const { return m_alias.empty(); }
+
+	// Outcome for a uniform u in [0, 1): the integer part of u * n picks the column and the fraction decides
+	// between the column's own outcome and its alias
+	std::uint32_t sample(double u) const {
+		const double scaled = u * static_cast<double>(m_alias.size());
+		std::size_t column = static_cast<std::size_t>(scaled);
+		column = column < m_alias.size() ? column : m_alias.size() - 1;
+		return scaled - static_cast<double>(column) < m_threshold[column] ? static_cast<std::uint32_t>(column) : m_alias[column];
+	}
+
+	std::uint32_t sample(PhiloxEngine& engine) const { return sample(engine.uniform()); }
+
+	// Fill out[0..n) with independent outcomes
+	void sample(PhiloxEngine& engine, std::uint32_t* out, std::size_t n) const {
+		for(std::size_t i = 0; i < n; ++i)
+			out[i] = sample(engine.uniform());
+	}
+
+	// Probability of drawing an outcome, reconstructed from the table
+	double probability(std::size_t outcome) const {
+		double mass = m_threshold[outcome];
+		for(std::size_t column = 0; column < m_alias.size(); ++column) {
+			if(m_alias[column] == outcome && column != outcome)
+				mass += 1.0 - m_threshold[column];
+		}
+		return mass / static_cast<double>(m_alias.size());
+	}
+};
+
+#endif // ALIAS_SAMPLER_HPP
@@ -1,129 +1,122 @@
 // Project-2 - Luca Vicaria - PHYS30762
 // This file defines boson classes including their properties and interactions within the simulation.
 // It deals with particle properties such as mass, charge, spin, and decay mechanisms.
-// Last modified 08/05/2024
+// Last modified 16/10/2026
 
 #ifndef BOSONS_HPP
 #define BOSONS_HPP
 
 #include <iostream>
-#include <map>
 #include <string>
-#include <sstream>
 
 #include "particle.hpp"
+#include "decay_modes.hpp"
 #include "quarks.hpp"
 #include "leptons.hpp"
 
-// Define properties for Bosons
+// Numeric boson properties, indexed by BosonType
 template <>
-std::map<BosonType, std::map<std::string, std::string>> GenericParticle<BosonType>::m_staticProps{
-	{BosonType::Photon, {{"name", "Photon"}, {"mass", "0"}, {"charge", "0"}, {"spin", "1"}}},
-	{BosonType::W,      {{"name", "W Boson"}, {"mass", "80360"}, {"charge", "+1"}, {"spin", "1"}}},
-	{BosonType::Z,      {{"name", "Z Boson"}, {"mass", "91190"}, {"charge", "0"}, {"spin", "1"}}},
-	{BosonType::Gluon,  {{"name", "Gluon"}, {"mass", "0"}, {"charge", "0"}, {"spin", "1"}}},
-	{BosonType::Higgs,  {{"name", "Higgs Boson"}, {"mass", "125110"}, {"charge", "0"}, {"spin", "0"}}}
+struct ParticlePropertyTable<BosonType> {
+	static constexpr std::array<ParticleProperties, 5> values{{
+		{"Photon", 0.0, 0, 2, 22},
+		{"W Boson", 80360.0, 3, 2, 24},
+		{"Z Boson", 91190.0, 0, 2, 23},
+		{"Gluon", 0.0, 0, 2, 21},
+		{"Higgs Boson", 125110.0, 0, 0, 25}
+	}};
+
+	static constexpr const ParticleProperties& get(BosonType type) { return values[static_cast<std::size_t>(type)]; }
 };
 
 // Specific Boson class deriving from GenericParticle
 class Boson : public GenericParticle<BosonType> {
 public:
-	Boson(BosonType type, std::shared_ptr<FourMomentum> fourMomentum, bool isAntiParticle = false): GenericParticle<BosonType>(type, fourMomentum, isAntiParticle) {}
+	Boson(BosonType type, ParticleMomentum fourMomentum, bool isAntiParticle = false): GenericParticle<BosonType>(type, fourMomentum, isAntiParticle) {}
 };
 
 class Photon : public Boson {
 public:
-	Photon(std::shared_ptr<FourMomentum> fourMomentum, bool isAntiParticle = false) : Boson(BosonType::Photon, fourMomentum, isAntiParticle) {}
+	Photon(ParticleMomentum fourMomentum, bool isAntiParticle = false) : Boson(BosonType::Photon, fourMomentum, isAntiParticle) {}
 
 	std::shared_ptr<Particle> getAntiParticle() const override {
-		auto positron = std::make_shared<Photon>(m_fourMomentum, !m_isAntiParticle);
+		auto positron = makeEventShared<Photon>(m_fourMomentum.get(), !m_isAntiParticle);
 		return std::static_pointer_cast<Particle>(positron);
 	}
 };
 
 class WBoson : public Boson {
 public:
-	WBoson(std::shared_ptr<FourMomentum> fourMomentum, bool isAntiParticle = false) : Boson(BosonType::W, fourMomentum, isAntiParticle) {}
+	WBoson(ParticleMomentum fourMomentum, bool isAntiParticle = false) : Boson(BosonType::W, fourMomentum, isAntiParticle) {}
 
 	std::shared_ptr<Particle> getAntiParticle() const override {
 		// W boson antiparticle with opposite charge
-		auto antiW = std::make_shared<WBoson>(m_fourMomentum, !m_isAntiParticle);
+		auto antiW = makeEventShared<WBoson>(m_fourMomentum.get(), !m_isAntiParticle);
 		return std::static_pointer_cast<Particle>(antiW);
 	}
 
   	// Set the decay particles for the W boson
 	void setDecayParticles(const std::vector<std::shared_ptr<Particle>>& decayParticles) {
-		if(validateDecayParticles(decayParticles))
+		if(validateDecayParticles(decayParticles)) {
+			METRICS_INCREMENT(DecaysAccepted);
 			m_decayParticles = decayParticles;
-		else
+		}
+		else {
+			METRICS_INCREMENT(DecaysRejected);
 			throw std::invalid_argument("Decay particles do not conserve the required properties.");
-	}
-
-	std::string getInfo() const override {
-		std::stringstream ss;
-		ss<<Boson::getInfo();
-		if(!m_decayParticles.empty()) {
-			ss<<", Decay Particles: ";
-			for(const auto& particle : m_decayParticles) {
-				ss<<particle->getName()<<", ";
-			}
-			std::string result = ss.str();
-			return result.substr(0, result.size() - 2);
 		}
-		return ss.str();
 	}
 
 protected:
+	void formatFields(ParticleFieldWriter& writer) const override {
+		Boson::formatFields(writer);
+		formatDecayParticles(writer);
+	}
+
 	bool validateDecayParticles(const std::vector<std::shared_ptr<Particle>>& decayParticles) {
-		return decayParticles.size() == 2 && checkChargeConservation(decayParticles);
+		return decayParticles.size() == 2 && DecayModeRegistry::isAllowed(*this, decayParticles) && checkChargeConservation(decayParticles);
     }
 };
 
 class ZBoson : public Boson {
 public:
-	ZBoson(std::shared_ptr<FourMomentum> fourMomentum) : Boson(BosonType::Z, fourMomentum, false) {}
+	ZBoson(ParticleMomentum fourMomentum) : Boson(BosonType::Z, fourMomentum, false) {}
 
 	std::shared_ptr<Particle> getAntiParticle() const override {
 		// Z boson is its own antiparticle
-		auto zBoson = std::make_shared<ZBoson>(m_fourMomentum);
+		auto zBoson = makeEventShared<ZBoson>(m_fourMomentum.get());
 		return std::static_pointer_cast<Particle>(zBoson);
 	}
 
 	void setDecayParticles(const std::vector<std::shared_ptr<Particle>>& decayParticles) {
-		if(validateDecayParticles(decayParticles))
+		if(validateDecayParticles(decayParticles)) {
+			METRICS_INCREMENT(DecaysAccepted);
 			m_decayParticles = decayParticles;
-		else
+		}
+		else {
+			METRICS_INCREMENT(DecaysRejected);
 			throw std::invalid_argument("\nDecay particles do not conserve the required properties.");
-	}
-
-	std::string getInfo() const override {
-		std::stringstream ss;
-		ss<<Boson::getInfo();
-		if(!m_decayParticles.empty()) {
-			ss<<", Decay Particles: ";
-			for(const auto& particle : m_decayParticles) {
-				ss<<particle->getName()<<", ";
-			}
-		std::string result = ss.str();
-		return result.substr(0, result.size() - 2);
 		}
-		return ss.str();
 	}
 
 protected:
+	void formatFields(ParticleFieldWriter& writer) const override {
+		Boson::formatFields(writer);
+		formatDecayParticles(writer);
+	}
+
 	bool validateDecayParticles(const std::vector<std::shared_ptr<Particle>>& decayParticles) {
-		return decayParticles.size() == 2 && checkChargeConservation(decayParticles);
+		return decayParticles.size() == 2 && DecayModeRegistry::isAllowed(*this, decayParticles) && checkChargeConservation(decayParticles);
 	}
 };
 
 class Gluon : public Boson {
 public:
-	Gluon(std::shared_ptr<FourMomentum> fourMomentum, ColourCharge colour, ColourCharge antiColour) 
+	Gluon(ParticleMomentum fourMomentum, ColourCharge colour, ColourCharge antiColour) 
 		: Boson(BosonType::Gluon, fourMomentum, false), m_colourCharge(colour), m_antiColorCharge(antiColour) { checkConsistency(); }
 
 	std::shared_ptr<Particle> getAntiParticle() const override {
 		// Swaps color and anti-colour for the antiparticle
-		auto gluon = std::make_shared<Gluon>(m_fourMomentum, m_antiColorCharge, m_colourCharge);
+		auto gluon = makeEventShared<Gluon>(m_fourMomentum.get(), m_antiColorCharge, m_colourCharge);
 		return std::static_pointer_cast<Particle>(gluon);
 	}
 
@@ -139,13 +132,12 @@ public:
 					 colour == ColourCharge::AntiRed || colour == ColourCharge::AntiGreen || colour == ColourCharge::AntiBlue;
 	}
 
-	std::string getInfo() const override {
-		std::stringstream ss;
-		ss<<Boson::getInfo(); // Get base particle information
-		ss<<", Colour Charge: "<<Quark::colourChargeToString(m_colourCharge)
-			<<", Anti-Colour Charge: "<<Quark::colourChargeToString(m_antiColorCharge);
-		return ss.str();
-}
+protected:
+	void formatFields(ParticleFieldWriter& writer) const override {
+		Boson::formatFields(writer);
+		writer.field("colour_charge", "Colour Charge", Quark::colourChargeName(m_colourCharge), TextLabel::Colon);
+		writer.field("anti_colour_charge", "Anti-Colour Charge", Quark::colourChargeName(m_antiColorCharge), TextLabel::Colon);
+	}
 
 private:
 	ColourCharge m_colourCharge;
@@ -154,43 +146,38 @@ private:
 
 class HiggsBoson : public Boson {
 public:
-	HiggsBoson(std::shared_ptr<FourMomentum> fourMomentum) : Boson(BosonType::Higgs, fourMomentum, false) {}
+	HiggsBoson(ParticleMomentum fourMomentum) : Boson(BosonType::Higgs, fourMomentum, false) {}
 
 	std::shared_ptr<Particle> getAntiParticle() const override {
 		// Higgs boson is its own antiparticle
-		auto higgsBoson = std::make_shared<HiggsBoson>(m_fourMomentum);
+		auto higgsBoson = makeEventShared<HiggsBoson>(m_fourMomentum.get());
 		return std::static_pointer_cast<Particle>(higgsBoson);
 	}
 
 	void setDecayParticles(const std::vector<std::shared_ptr<Particle>>& decayParticles) {
-		if(validateDecayParticles(decayParticles))
+		if(validateDecayParticles(decayParticles)) {
+			METRICS_INCREMENT(DecaysAccepted);
 			m_decayParticles = decayParticles;
-		else
+		}
+		else {
+			METRICS_INCREMENT(DecaysRejected);
 			throw std::invalid_argument("\nDecay particles do not conserve the required properties.");
-	}
-
-	std::string getInfo() const override {
-		std::stringstream ss;
-		ss<<Boson::getInfo();
-		if(!m_decayParticles.empty()) {
-			ss<<", Decay Particles: ";
-			for(const auto& particle : m_decayParticles) {
-				ss<<particle->getName()<<", ";
-			}
-		std::string result = ss.str();
-		return result.substr(0, result.size() - 2);
 		}
-		return ss.str();
 	}
 
 protected:
+	void formatFields(ParticleFieldWriter& writer) const override {
+		Boson::formatFields(writer);
+		formatDecayParticles(writer);
+	}
+
 	bool validateDecayParticles(const std::vector<std::shared_ptr<Particle>>& decayParticles) {
-		// Higgs boson decays typically result in pairs (like ZZ, WW, or bb)
-		return (decayParticles.size() == 2 || decayParticles.size() == 4) && checkChargeConservation(decayParticles) && checkDecayModes(decayParticles);
+		// Higgs boson decays result in pairs (like ZZ, WW, or bb), with the vector bosons possibly off shell
+		return decayParticles.size() == 2 && checkDecayModes(decayParticles) && checkChargeConservation(decayParticles);
 	}
 
 	bool checkDecayModes(const std::vector<std::shared_ptr<Particle>>& decayParticles) {
-		return true;
+		return DecayModeRegistry::isAllowed(*this, decayParticles);
 	}
 };
 
@@ -0,0 +1,354 @@
+// Project-2 - Luca Vicaria - PHYS30762
+// This file defines a segmented electromagnetic calorimeter: longitudinal layers, each divided into a dense grid of
+// eta-phi cells. Electron and photon showers follow the Gamma-function longitudinal profile
+//     dE/dt = E b (bt)^(a-1) exp(-bt) / Gamma(a),  t in radiation lengths,  t_max = (a-1)/b = ln(E/E_c) + C,
+// with C = -0.5 for electrons and +0.5 for photons (PDG review, "Passage of particles through matter").
+// The fraction deposited in each layer is a difference of regularized incomplete gamma functions. These are
+// tabulated once against t_max, so depositing a batch of particles is a table interpolation per particle and layer.
+// Last modified 16/10/2026
+
+#ifndef CALORIMETER_HPP
+#define CALORIMETER_HPP
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include "four_momentum.hpp"
+#include "four_momentum_batch.hpp"
+
+enum class ShowerType : std::uint8_t { Electron, Photon };
+
+// Regularized lower incomplete gamma function P(a, x) = gamma(a, x) / Gamma(a), for a > 0 and x >= 0.
+// Uses the power series below x = a + 1 and Lentz's continued fraction for Q = 1 - P above it.
+inline double regularizedGammaP(double a, double x) {
+	if(a <= 0.0)
+		throw std::invalid_argument("regularizedGammaP requires a > 0.");
+	if(x <= 0.0)
+		return 0.0;
+
+	constexpr int MAX_ITERATIONS = 500;
+	constexpr double EPSILON = 1e-15;
+	const double logPrefactor = a * std::log(x) - x - std::lgamma(a);
+
+	if(x < a + 1.0) {
+		double term = 1.0 / a, sum = term;
+		for(int n = 1; n < MAX_ITERATIONS && std::abs(term) > std::abs(sum) * EPSILON; ++n) {
+			term *= x / (a + n);
+			sum += term;
+		}
+		return std::min(1.0, sum * std::exp(logPrefactor));
+	}
+
+	constexpr double TINY = std::numeric_limits<double>::min() / EPSILON;
+	double b = x + 1.0 - a, c = 1.0 / TINY, d = 1.0 / b, h = d;
+	for(int i = 1; i < MAX_ITERATIONS; ++i) {
+		const double an = -i * (i - a);
+		b += 2.0;
+		d = an * d + b;
+		if(std::abs(d) < TINY)
+			d = TINY;
+		c = b + an / c;
+		if(std::abs(c) < TINY)
+			c = TINY;
+		d = 1.0 / d;
+		const double delta = d * c;
+		h *= delta;
+		if(std::abs(delta - 1.0) < EPSILON)
+			break;
+	}
+	return std::max(0.0, 1.0 - std::exp(logPrefactor) * h);
+}
+
+struct CalorimeterGeometry {
+	// Depth of the back of each layer in radiation lengths. The last layer also absorbs the tail of the shower,
+	// so the layer energies always sum to the particle's energy.
+	std::vector<double> layerDepths = {3.0, 10.0, 18.0, 25.0};
+	std::size_t etaCells = 50;
+	std::size_t phiCells = 64;
+	double etaMax = 2.5;                 // Cells cover -etaMax <= eta < etaMax
+	double criticalEnergy = 10.0;        // E_c of the absorber in MeV
+	double profileB = 0.5;               // Gamma profile scale parameter b
+
+	std::size_t layers() const { return layerDepths.size(); }
+	std::size_t cellsPerLayer() const { return etaCells * phiCells; }
+
+	void validate() const {
+		if(layerDepths.empty() || etaCells == 0 || phiCells == 0)
+			throw std::invalid_argument("A calorimeter needs at least one layer and one eta-phi cell.");
+		for(std::size_t i = 0; i < layerDepths.size(); ++i) {
+			if(layerDepths[i] <= (i == 0 ? 0.0 : layerDepths[i - 1]))
+				throw std::invalid_argument("Calorimeter layer depths must be positive and increasing.");
+		}
+		if(etaMax <= 0.0 || criticalEnergy <= 0.0 || profileB <= 0.0)
+			throw std::invalid_argument("Calorimeter etaMax, critical energy and profile b must be positive.");
+	}
+};
+
+// Fraction of a shower's energy deposited in each layer, tabulated against the shower maximum t_max
+class ShowerProfile {
+private:
+	static constexpr std::size_t BINS_PER_X0 = 32;
+	static constexpr double MAX_T_MAX = 16.0; // Reached at about 150 TeV for E_c = 10 MeV
+	static constexpr std::size_t BIN_COUNT = static_cast<std::size_t>(MAX_T_MAX) * BINS_PER_X0 + 1;
+
+	std::vector<double> m_depths;
+	double m_logCriticalEnergy;
+	double m_b;
+	std::vector<double> m_table; // m_table[layer * BIN_COUNT + bin]
+
+public:
+	explicit ShowerProfile(const CalorimeterGeometry& geometry = CalorimeterGeometry())
+		: m_depths(geometry.layerDepths), m_logCriticalEnergy(std::log(geometry.criticalEnergy)), m_b(geometry.profileB),
+		  m_table(geometry.layers() * BIN_COUNT) {
+		geometry.validate();
+		std::vector<double> fractions(layers());
+		for(std::size_t bin = 0; bin < BIN_COUNT; ++bin) {
+			exactFractions(static_cast<double>(bin) / BINS_PER_X0, fractions.data());
+			for(std::size_t layer = 0; layer < layers(); ++layer)
+				m_table[layer * BIN_COUNT + bin] = fractions[layer];
+		}
+	}
+
+	// Shared profile for the default geometry
+	static const ShowerProfile& standard() {
+		static const ShowerProfile profile;
+		return profile;
+	}
+
+	std::size_t layers() const { return m_depths.size(); }
+
+	// Depth of the shower maximum in radiation lengths, clamped to the tabulated range
+	double showerMaximum(double energy, ShowerType type) const {
+		if(!(energy > 0.0))
+			return 0.0;
+		const double offset = type == ShowerType::Electron ? -0.5 : 0.5;
+		return std::clamp(std::log(energy) - m_logCriticalEnergy + offset, 0.0, MAX_T_MAX);
+	}
+
+	// Layer fractions computed directly from the incomplete gamma function, for a shower maximum at tMax
+	void exactFractions(double tMax, double* out) const {
+		const double a = 1.0 + m_b * tMax;
+		double previous = 0.0;
+		for(std::size_t layer = 0; layer + 1 < layers(); ++layer) {
+			const double cumulative = regularizedGammaP(a, m_b * m_depths[layer]);
+			out[layer] = cumulative - previous;
+			previous = cumulative;
+		}
+		out[layers() - 1] = 1.0 - previous;
+	}
+
+	// Table position of a shower: interpolate between bin and bin + 1 with the given weight
+	void locate(double energy, ShowerType type, std::uint32_t& bin, double& weight) const {
+		const double position = showerMaximum(energy, type) * BINS_PER_X0;
+		bin = static_cast<std::uint32_t>(std::min(static_cast<std::size_t>(position), BIN_COUNT - 2));
+		weight = position - bin;
+	}
+
+	double fraction(std::size_t layer, std::uint32_t bin, double weight) const {
+		const double* row = m_table.data() + layer * BIN_COUNT;
+		return row[bin] + weight * (row[bin + 1] - row[bin]);
+	}
+
+	// Interpolated layer fractions for a shower of the given energy in MeV; they sum to one
+	void fractions(double energy, ShowerType type, double* out) const {
+		std::uint32_t bin;
+		double weight;
+		locate(energy, type, bin, weight);
+		for(std::size_t layer = 0; layer < layers(); ++layer)
+			out[layer] = fraction(layer, bin, weight);
+	}
+};
+
+// Dense energy grid of layers x eta cells x phi cells, filled by batches of electromagnetic showers.
+// A shower is deposited in the cell its direction points at; lateral spread is not modelled.
+class Calorimeter {
+private:
+	static constexpr double TWO_PI = 6.283185307179586;
+
+	CalorimeterGeometry m_geometry;
+	ShowerProfile m_profile;
+	AlignedDoubleVector m_cells; // m_cells[(layer * etaCells + etaIndex) * phiCells + phiIndex]
+	double m_outOfAcceptance = 0.0;
+	double m_etaCellWidth;
+	double m_phiCellWidth;
+	std::vector<double> m_sinhEtaEdges; // sinh(eta) = pz / pt at each eta cell edge, for exact bin boundaries
+
+	// Scratch space reused between batches
+	std::vector<double> m_weights, m_fractions;
+	std::vector<std::uint32_t> m_bins;
+	std::vector<std::int64_t> m_cellIndex;
+	std::vector<ShowerType> m_types;
+
+public:
+	explicit Calorimeter(CalorimeterGeometry geometry = CalorimeterGeometry())
+		: m_geometry(std::move(geometry)), m_profile(m_geometry), m_cells(m_geometry.layers() * m_geometry.cellsPerLayer(), 0.0),
+		  m_etaCellWidth(2.0 * m_geometry.etaMax / m_geometry.etaCells), m_phiCellWidth(TWO_PI / m_geometry.phiCells) {
+		for(std::size_t edge = 0; edge <= m_geometry.etaCells; ++edge)
+			m_sinhEtaEdges.push_back(std::sinh(-m_geometry.etaMax + edge * m_etaCellWidth));
+	}
+
+	const CalorimeterGeometry& geometry() const { return m_geometry; }
+	const ShowerProfile& profile() const { return m_profile; }
+
+	// Flat cell index in a layer for a direction, or -1 outside the eta acceptance
+	std::int64_t cellIndex(double eta, double phi) const {
+		if(!(eta >= -m_geometry.etaMax && eta < m_geometry.etaMax))
+			return -1;
+		const std::size_t etaIndex = std::min(static_cast<std::size_t>((eta + m_geometry.etaMax) / m_etaCellWidth), m_geometry.etaCells - 1);
+		std::size_t phiIndex = static_cast<std::size_t>((phi + 0.5 * TWO_PI) / m_phiCellWidth);
+		if(phiIndex >= m_geometry.phiCells)
+			phiIndex = m_geometry.phiCells - 1; // phi == pi
+		return static_cast<std::int64_t>(etaIndex * m_geometry.phiCells + phiIndex);
+	}
+
+	// Flat cell index in a layer for the direction of a three-momentum, or -1 outside the eta acceptance
+	std::int64_t cellIndex(double px, double py, double pz) const {
+		const double pt = std::sqrt(px * px + py * py);
+		const double sinhEta = pt > 0.0 ? pz / pt : (pz == 0.0 ? 0.0 : std::copysign(std::numeric_limits<double>::infinity(), pz));
+		if(!(sinhEta >= m_sinhEtaEdges.front() && sinhEta < m_sinhEtaEdges.back()))
+			return -1;
+
+		// |eta| = ln((|pz| + p) / pt) is cheaper than asinh; rounding can put it one cell out, which the edges correct
+		const double absEta = std::log((std::abs(pz) + std::sqrt(pz * pz + pt * pt)) / pt);
+		const double eta = pz < 0.0 ? -absEta : absEta;
+		std::size_t etaIndex = std::min(static_cast<std::size_t>(std::max(0.0, (eta + m_geometry.etaMax) / m_etaCellWidth)), m_geometry.etaCells - 1);
+		if(sinhEta < m_sinhEtaEdges[etaIndex])
+			--etaIndex;
+		else if(sinhEta >= m_sinhEtaEdges[etaIndex + 1])
+			++etaIndex;
+
+		std::size_t phiIndex = static_cast<std::size_t>((std::atan2(py, px) + 0.5 * TWO_PI) / m_phiCellWidth);
+		if(phiIndex >= m_geometry.phiCells)
+			phiIndex = m_geometry.phiCells - 1; // phi == pi
+		return static_cast<std::int64_t>(etaIndex * m_geometry.phiCells + phiIndex);
+	}
+
+	// Centre of a cell
+	double etaOf(std::size_t etaIndex) const { return -m_geometry.etaMax + (etaIndex + 0.5) * m_etaCellWidth; }
+	double phiOf(std::size_t phiIndex) const { return -0.5 * TWO_PI + (phiIndex + 0.5) * m_phiCellWidth; }
+
+	// Deposit a batch of showers; types[i] gives the species of row i
+	void deposit(const FourMomentumBatch& momenta, const ShowerType* types) {
+		const std::size_t n = momenta.size();
+		if(n == 0)
+			return;
+		m_cellIndex.resize(n);
+		m_bins.resize(n);
+		m_weights.resize(n);
+		m_fractions.resize(n);
+
+		const double* energy = momenta.energy_data();
+		const double* px = momenta.px_data();
+		const double* py = momenta.py_data();
+		const double* pz = momenta.pz_data();
+		for(std::size_t i = 0; i < n; ++i) {
+			m_cellIndex[i] = cellIndex(px[i], py[i], pz[i]);
+			if(m_cellIndex[i] < 0)
+				m_outOfAcceptance += energy[i];
+			m_profile.locate(energy[i], types[i], m_bins[i], m_weights[i]);
+		}
+
+		// One layer at a time: a gather-and-interpolate loop the compiler can vectorise, then the scatter into cells
+		const std::size_t cellsPerLayer = m_geometry.cellsPerLayer();
+		for(std::size_t layer = 0; layer < m_geometry.layers(); ++layer) {
+			double* layerEnergies = m_fractions.data();
+			for(std::size_t i = 0; i < n; ++i)
+				layerEnergies[i] = energy[i] * m_profile.fraction(layer, m_bins[i], m_weights[i]);
+
+			double* cells = m_cells.data() + layer * cellsPerLayer;
+			for(std::size_t i = 0; i < n; ++i) {
+				if(m_cellIndex[i] >= 0)
+					cells[m_cellIndex[i]] += layerEnergies[i];
+			}
+		}
+	}
+
+	// Deposit a batch of showers of one species
+	void deposit(const FourMomentumBatch& momenta, ShowerType type) {
+		m_types.assign(momenta.size(), type);
+		deposit(momenta, m_types.data());
+	}
+
+	void deposit(const FourMomentum& momentum, ShowerType type) {
+		const std::int64_t cell = cellIndex(momentum.get_px(), momentum.get_py(), momentum.get_pz());
+		if(cell < 0) {
+			m_outOfAcceptance += momentum.get_energy();
+			return;
+		}
+		m_fractions.resize(m_geometry.layers());
+		m_profile.fractions(momentum.get_energy(), type, m_fractions.data());
+		for(std::size_t layer = 0; layer < m_geometry.layers(); ++layer)
+			m_cells[layer * m_geometry.cellsPerLayer() + cell] += momentum.get_energy() * m_fractions[layer];
+	}
+
+	void clear() {
+		std::fill(m_cells.begin(), m_cells.end(), 0.0);
+		m_outOfAcceptance = 0.0;
+	}
+
+	double cell(std::size_t layer, std::size_t etaIndex, std::size_t phiIndex) const {
+		return m_cells[(layer * m_geometry.etaCells + etaIndex) * m_geometry.phiCells + phiIndex];
+	}
+
+	// Cells of one layer, eta-major
+	const double* layerData(std::size_t layer) const { return m_cells.data() + layer * m_geometry.cellsPerLayer(); }
+
+	// Energy summed over layers for every eta-phi tower, written to out[etaIndex * phiCells + phiIndex]
+	void towerEnergies(double* out) const {
+		const std::size_t cellsPerLayer = m_geometry.cellsPerLayer();
+		std::copy(m_cells.begin(), m_cells.begin() + cellsPerLayer, out);
+		for(std::size_t layer = 1; layer < m_geometry.layers(); ++layer) {
+			const double* cells = m_cells.data() + layer * cellsPerLayer;
+			for(std::size_t i = 0; i < cellsPerLayer; ++i)
+				out[i] += cells[i];
+		}
+	}
+
+	std::vector<double> towerEnergies() const {
+		std::vector<double> out(m_geometry.cellsPerLayer());
+		towerEnergies(out.data());
+		return out;
+	}
+
+	// Append a massless four-momentum pointing at the centre of every tower with more than minEnergy, e.g. as jet
+	// clustering input
+	void towerMomenta(FourMomentumBatch& out, double minEnergy = 0.0) const {
+		const std::vector<double> towers = towerEnergies();
+		for(std::size_t etaIndex = 0; etaIndex < m_geometry.etaCells; ++etaIndex) {
+			const double coshEta = std::cosh(etaOf(etaIndex)), sinhEta = std::sinh(etaOf(etaIndex));
+			for(std::size_t phiIndex = 0; phiIndex < m_geometry.phiCells; ++phiIndex) {
+				const double energy = towers[etaIndex * m_geometry.phiCells + phiIndex];
+				if(energy > minEnergy) {
+					const double pt = energy / coshEta;
+					out.push_back(energy, pt * std::cos(phiOf(phiIndex)), pt * std::sin(phiOf(phiIndex)), pt * sinhEta);
+				}
+			}
+		}
+	}
+
+	double layerEnergy(std::size_t layer) const {
+		const double* cells = layerData(layer);
+		double total = 0.0;
+		for(std::size_t i = 0; i < m_geometry.cellsPerLayer(); ++i)
+			total += cells[i];
+		return total;
+	}
+
+	double totalEnergy() const {
+		double total = 0.0;
+		for(double energy : m_cells)
+			total += energy;
+		return total;
+	}
+
+	// Energy of showers that fell outside the eta acceptance
+	double outOfAcceptanceEnergy() const { return m_outOfAcceptance; }
+};
+
+#endif // CALORIMETER_HPP
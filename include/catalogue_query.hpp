@@ -0,0 +1,338 @@
+// Project-2 - Luca Vicaria - PHYS30762
+// This file defines the non-interactive query interface to the particle catalogue.
+// A query is one line of text: a particle name, alias or PDG ID, or one of the commands "count <category>",
+// "mass <min> <max>" (MeV), "sum" and "metrics". Results are written as JSON Lines or CSV into a buffer that is flushed
+// in large blocks, so scripts can stream millions of queries without per-line flushing.
+// Last modified 16/10/2026
+
+#ifndef CATALOGUE_QUERY_HPP
+#define CATALOGUE_QUERY_HPP
+
+#include <cctype>
+#include <charconv>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <utility>
+
+#include "metrics.hpp"
+#include "trace.hpp"
+#include "particle.hpp"
+#include "particle_format.hpp"
+#include "particle_catalogue.hpp"
+
+enum class QueryFormat { JsonLines, Csv };
+
+inline QueryFormat parseQueryFormat(const std::string& name) {
+	if(name == "jsonl" || name == "json")
+		return QueryFormat::JsonLines;
+	if(name == "csv")
+		return QueryFormat::Csv;
+	throw std::invalid_argument("Unknown output format '" + name + "', expected jsonl or csv.");
+}
+
+// Formats query results into an internal buffer. When writing to a FILE* the buffer is written out
+// once it grows past the flush threshold and whatever remains is written by flush(); otherwise it is read through buffer().
+class QueryWriter {
+private:
+	static constexpr std::size_t FLUSH_THRESHOLD = 64 * 1024;
+
+	QueryFormat m_format;
+	std::FILE* m_file;
+	std::string m_buffer;
+
+	void appendNumber(double value) { format_detail::appendNumber(m_buffer, value); }
+	void appendNumber(long long value) { format_detail::appendNumber(m_buffer, value); }
+	void appendJsonString(std::string_view text) { format_detail::appendJsonString(m_buffer, text); }
+	void appendCsvField(std::string_view text) { format_detail::appendCsvField(m_buffer, text); }
+
+	void beginRecord(std::string_view query, std::string_view result) {
+		if(m_format == QueryFormat::JsonLines) {
+			m_buffer += "{\"query\":";
+			appendJsonString(query);
+			m_buffer += ",\"result\":\"";
+			m_buffer.append(result);
+			m_buffer += '"';
+		}
+		else {
+			appendCsvField(query);
+			m_buffer += ',';
+			m_buffer.append(result);
+		}
+	}
+
+	void endRecord() {
+		m_buffer += m_format == QueryFormat::JsonLines ? "}\n" : "\n";
+		if(m_file && m_buffer.size() >= FLUSH_THRESHOLD)
+			flush();
+	}
+
+public:
+	static constexpr std::string_view CSV_HEADER = "query,result,name,pdg,type,mass,charge,spin,count,e,px,py,pz\n";
+
+	// Write to a stream, e.g. stdout, in blocks of about 64 kB
+	explicit QueryWriter(QueryFormat format, std::FILE* file = nullptr) : m_format(format), m_file(file) {
+		m_buffer.reserve(2 * FLUSH_THRESHOLD);
+	}
+
+	QueryFormat format() const { return m_format; }
+
+	void writeHeader() {
+		if(m_format == QueryFormat::Csv)
+			m_buffer.append(CSV_HEADER);
+	}
+
+	void writeParticle(std::string_view query, const Particle& particle) {
+		beginRecord(query, "particle");
+		if(m_format == QueryFormat::JsonLines) {
+			m_buffer += ",\"name\":";
+			appendJsonString(particle.getNameView());
+			m_buffer += ",\"pdg\":";
+			appendNumber(static_cast<long long>(particle.getPdgId()));
+			m_buffer += ",\"type\":";
+			appendJsonString(particle.getTypeView());
+			m_buffer += ",\"mass\":";
+			appendNumber(particle.getMassValue());
+			m_buffer += ",\"charge\":";
+			appendJsonString(particle.getCharge());
+			m_buffer += ",\"spin\":";
+			appendJsonString(particle.getSpin());
+		}
+		else {
+			m_buffer += ',';
+			appendCsvField(particle.getNameView());
+			m_buffer += ',';
+			appendNumber(static_cast<long long>(particle.getPdgId()));
+			m_buffer += ',';
+			appendCsvField(particle.getTypeView());
+			m_buffer += ',';
+			appendNumber(particle.getMassValue());
+			m_buffer += ',';
+			appendCsvField(particle.getCharge());
+			m_buffer += ',';
+			appendCsvField(particle.getSpin());
+			m_buffer += ",,,,,";
+		}
+		endRecord();
+	}
+
+	void writeCount(std::string_view query, std::size_t count) {
+		beginRecord(query, "count");
+		if(m_format == QueryFormat::JsonLines) {
+			m_buffer += ",\"count\":";
+			appendNumber(static_cast<long long>(count));
+		}
+		else {
+			m_buffer += ",,,,,,,";
+			appendNumber(static_cast<long long>(count));
+			m_buffer += ",,,,";
+		}
+		endRecord();
+	}
+
+	void writeFourMomentum(std::string_view query, const FourMomentum& momentum) {
+		beginRecord(query, "four_momentum");
+		const double components[4] = {momentum.get_energy(), momentum.get_px(), momentum.get_py(), momentum.get_pz()};
+		if(m_format == QueryFormat::JsonLines) {
+			const char* keys[4] = {",\"e\":", ",\"px\":", ",\"py\":", ",\"pz\":"};
+			for(int i = 0; i < 4; ++i) {
+				m_buffer += keys[i];
+				appendNumber(components[i]);
+			}
+		}
+		else {
+			m_buffer += ",,,,,,,"; // name to count are empty
+			for(int i = 0; i < 4; ++i) {
+				m_buffer += ',';
+				appendNumber(components[i]);
+			}
+		}
+		endRecord();
+	}
+
+	// One named metric value, reported in the count column
+	void writeMetric(std::string_view query, std::string_view name, std::uint64_t value) {
+		beginRecord(query, "metric");
+		if(m_format == QueryFormat::JsonLines) {
+			m_buffer += ",\"name\":";
+			appendJsonString(name);
+			m_buffer += ",\"count\":";
+		}
+		else {
+			m_buffer += ',';
+			appendCsvField(name);
+			m_buffer += ",,,,,,";
+		}
+		appendNumber(static_cast<long long>(value));
+		if(m_format == QueryFormat::Csv)
+			m_buffer += ",,,,";
+		endRecord();
+	}
+
+	// result is "not_found" or "error"
+	void writeFailure(std::string_view query, std::string_view result) {
+		beginRecord(query, result);
+		if(m_format == QueryFormat::Csv)
+			m_buffer += ",,,,,,,,,,,";
+		endRecord();
+	}
+
+	// Hand the buffered output to the stream, or leave it in buffer() when writing to memory
+	void flush() {
+		if(m_file && !m_buffer.empty()) {
+			TRACE_SPAN_ARG("QueryWriter::flush", "print", m_buffer.size());
+			std::fwrite(m_buffer.data(), 1, m_buffer.size(), m_file);
+			m_buffer.clear();
+		}
+	}
+
+	const std::string& buffer() const { return m_buffer; }
+	void clearBuffer() { m_buffer.clear(); }
+
+	~QueryWriter() { flush(); }
+};
+
+class CatalogueQuery {
+private:
+	static std::string_view trim(std::string_view text) {
+		const char* space = " \t\r\n";
+		std::size_t first = text.find_first_not_of(space);
+		if(first == std::string_view::npos)
+			return {};
+		return text.substr(first, text.find_last_not_of(space) - first + 1);
+	}
+
+	// Split off the first whitespace-separated word, leaving the trimmed remainder in text
+	static std::string_view nextWord(std::string_view& text) {
+		std::size_t end = text.find_first_of(" \t");
+		std::string_view word = text.substr(0, end);
+		text = end == std::string_view::npos ? std::string_view() : trim(text.substr(end));
+		return word;
+	}
+
+	static bool equalsIgnoreCase(std::string_view a, std::string_view lowerCase) {
+		if(a.size() != lowerCase.size())
+			return false;
+		for(std::size_t i = 0; i < a.size(); ++i) {
+			if(std::tolower(static_cast<unsigned char>(a[i])) != lowerCase[i])
+				return false;
+		}
+		return true;
+	}
+
+	static bool parseDouble(std::string_view text, double& value) {
+		auto result = std::from_chars(text.data(), text.data() + text.size(), value);
+		return result.ec == std::errc() && result.ptr == text.data() + text.size();
+	}
+
+	static bool parseInt(std::string_view text, int& value) {
+		if(!text.empty() && text[0] == '+')
+			text.remove_prefix(1);
+		auto result = std::from_chars(text.data(), text.data() + text.size(), value);
+		return result.ec == std::errc() && result.ptr == text.data() + text.size();
+	}
+
+	// "lepton", "quark", "boson", "anti", "all" or "charge <thirds>"
+	static bool count(const ParticleCatalogue& catalogue, std::string_view what, std::size_t& result) {
+		std::string_view argument = what;
+		std::string_view word = nextWord(argument);
+		int thirds = 0;
+		if(equalsIgnoreCase(word, "lepton") || equalsIgnoreCase(word, "leptons"))
+			result = catalogue.countCategory(ParticleCategory::Lepton);
+		else if(equalsIgnoreCase(word, "quark") || equalsIgnoreCase(word, "quarks"))
+			result = catalogue.countCategory(ParticleCategory::Quark);
+		else if(equalsIgnoreCase(word, "boson") || equalsIgnoreCase(word, "bosons"))
+			result = catalogue.countCategory(ParticleCategory::Boson);
+		else if(equalsIgnoreCase(word, "anti"))
+			result = catalogue.countAntiParticles();
+		else if(equalsIgnoreCase(word, "all") || word.empty())
+			result = catalogue.size();
+		else if(equalsIgnoreCase(word, "charge") && parseInt(argument, thirds))
+			result = catalogue.countChargeThirds(thirds);
+		else
+			return false;
+		return true;
+	}
+
+	// One record per counter, and count, mean, p50, p90, p99 and max records per histogram, e.g. "query_ns.p99"
+	static void writeMetrics(std::string_view query, QueryWriter& writer) {
+		const metrics::Snapshot snapshot = metrics::registry().snapshot();
+		for(std::size_t i = 0; i < metrics::COUNTER_COUNT; ++i)
+			writer.writeMetric(query, metrics::COUNTER_NAMES[i], snapshot.counters[i]);
+
+		std::string name;
+		for(std::size_t i = 0; i < metrics::HISTOGRAM_COUNT; ++i) {
+			const metrics::HistogramSnapshot& histogram = snapshot.histograms[i];
+			const std::pair<std::string_view, std::uint64_t> statistics[] = {
+				{".count", histogram.count}, {".mean", static_cast<std::uint64_t>(histogram.mean())}, {".p50", histogram.quantile(0.5)},
+				{".p90", histogram.quantile(0.9)}, {".p99", histogram.quantile(0.99)}, {".max", histogram.quantile(1.0)}};
+			for(const auto& statistic : statistics) {
+				name.assign(metrics::HISTOGRAM_NAMES[i]);
+				name.append(statistic.first);
+				writer.writeMetric(query, name, statistic.second);
+			}
+		}
+	}
+
+public:
+	// Answers that change between identical queries, and so must not be cached
+	static bool isCacheable(std::string_view line) { return !equalsIgnoreCase(trim(line), "metrics"); }
+
+	// Answer one query line, writing one or more records. Blank lines and lines starting with '#' are skipped.
+	// Returns false if the line was skipped.
+	static bool answer(const ParticleCatalogue& catalogue, std::string_view line, QueryWriter& writer) {
+		METRICS_TIME_SAMPLED(QueryNs);
+		std::string_view query = trim(line);
+		if(query.empty() || query[0] == '#')
+			return false;
+
+		std::string_view rest = query;
+		std::string_view command = nextWord(rest);
+
+		if(equalsIgnoreCase(command, "count")) {
+			std::size_t result = 0;
+			if(count(catalogue, rest, result))
+				writer.writeCount(query, result);
+			else
+				writer.writeFailure(query, "error");
+			return true;
+		}
+		if(equalsIgnoreCase(command, "metrics") && rest.empty()) {
+			writeMetrics(query, writer);
+			return true;
+		}
+		if(equalsIgnoreCase(command, "sum") && rest.empty()) {
+			writer.writeFourMomentum(query, catalogue.totalFourMomentum());
+			return true;
+		}
+		if(equalsIgnoreCase(command, "mass")) {
+			std::string_view minText = nextWord(rest);
+			double minMass = 0.0, maxMass = 0.0;
+			if(!parseDouble(minText, minMass) || !parseDouble(rest, maxMass)) {
+				writer.writeFailure(query, "error");
+				return true;
+			}
+			ParticleView matches = catalogue.massRange(minMass, maxMass);
+			if(matches.empty())
+				writer.writeFailure(query, "not_found");
+			for(const Particle& particle : matches)
+				writer.writeParticle(query, particle);
+			return true;
+		}
+
+		// Anything else is a name, alias or PDG ID, optionally prefixed by "lookup"
+		std::string name(equalsIgnoreCase(command, "lookup") ? rest : query);
+		const Particle* particle = catalogue.resolve(name);
+		if(particle)
+			writer.writeParticle(query, *particle);
+		else
+			writer.writeFailure(query, "not_found");
+		return true;
+	}
+};
+
+#endif // CATALOGUE_QUERY_HPP
@@ -0,0 +1,332 @@
+// Project-2 - Luca Vicaria - PHYS30762
+// This file defines a local query server for the particle catalogue over a Unix domain socket, and its client.
+// The catalogue is loaded once into an immutable snapshot shared by every connection. RELOAD builds a new snapshot
+// and publishes it with an atomic pointer swap (RCU style): readers never block, and requests already in flight
+// finish against the snapshot they started with. Responses are cached in an LRU cache keyed by the query text.
+//
+// Protocol: the client sends one query per line, using the batch query syntax ("LOOKUP positron", "COUNT lepton",
+// "SUM", "MASS 1000 10000", "METRICS", or a bare name) or "RELOAD". The server answers each with one or more JSON lines
+// followed by an empty line.
+// Last modified 16/10/2026
+
+#ifndef CATALOGUE_SERVER_HPP
+#define CATALOGUE_SERVER_HPP
+
+#if !defined(_WIN32)
+
+#include <atomic>
+#include <cerrno>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <thread>
+
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include "catalogue_query.hpp"
+#include "lru_cache.hpp"
+#include "particle_catalogue.hpp"
+
+namespace socket_io {
+	// Open a Unix domain stream socket address for path, throwing if the path is too long
+	inline sockaddr_un address(const std::string& path) {
+		sockaddr_un addr{};
+		addr.sun_family = AF_UNIX;
+		if(path.empty() || path.size() >= sizeof(addr.sun_path))
+			throw std::invalid_argument("Socket path '" + path + "' is empty or too long.");
+		std::memcpy(addr.sun_path, path.c_str(), path.size() + 1);
+		return addr;
+	}
+
+	// Remove a socket left at path by a server that has exited. A socket that still accepts connections belongs to a
+	// running server and anything that is not a socket is not ours to delete, so both throw instead.
+	inline void removeStaleSocket(const std::string& path) {
+		struct stat status;
+		if(::lstat(path.c_str(), &status) < 0)
+			return; // Nothing there, or bind() will report why not
+		if(!S_ISSOCK(status.st_mode))
+			throw std::runtime_error("Cannot listen on '" + path + "': the path exists and is not a socket.");
+
+		int probe = ::socket(AF_UNIX, SOCK_STREAM, 0);
+		if(probe < 0)
+			throw std::runtime_error(std::string("socket() failed: ") + std::strerror(errno));
+		sockaddr_un addr = address(path);
+		int result = ::connect(probe, reinterpret_cast<const sockaddr*>(&addr), sizeof(addr));
+		int error = errno;
+		::close(probe);
+		if(result == 0)
+			throw std::runtime_error("Cannot listen on '" + path + "': another server is already listening there.");
+		if(error == ECONNREFUSED)
+			::unlink(path.c_str());
+	}
+
+	inline bool sendAll(int fd, std::string_view data) {
+		while(!data.empty()) {
+			ssize_t sent = ::send(fd, data.data(), data.size(), MSG_NOSIGNAL);
+			if(sent < 0 && errno == EINTR)
+				continue;
+			if(sent <= 0)
+				return false;
+			data.remove_prefix(static_cast<std::size_t>(sent));
+		}
+		return true;
+	}
+
+	// Buffered line reader over a socket. If the socket has a receive timeout, reads are retried after it expires
+	// until *stop becomes true.
+	class LineReader {
+	private:
+		int m_fd;
+		const std::atomic<bool>* m_stop;
+		std::string m_buffer;
+		std::size_t m_start = 0;
+
+	public:
+		explicit LineReader(int fd, const std::atomic<bool>* stop = nullptr) : m_fd(fd), m_stop(stop) {}
+
+		// Read the next line without its terminator, returning false at end of stream
+		bool next(std::string& line) {
+			while(true) {
+				std::size_t end = m_buffer.find('\n', m_start);
+				if(end != std::string::npos) {
+					line.assign(m_buffer, m_start, end - m_start);
+					m_start = end + 1;
+					return true;
+				}
+				m_buffer.erase(0, m_start);
+				m_start = 0;
+
+				char chunk[4096];
+				ssize_t received = ::recv(m_fd, chunk, sizeof(chunk), 0);
+				if(received < 0 && errno == EINTR)
+					continue;
+				if(received < 0 && (errno == EAGAIN || errno == EWOULDBLOCK) && m_stop && !m_stop->load())
+					continue;
+				if(received <= 0) {
+					// Treat an unterminated final line as a complete line
+					if(m_buffer.empty())
+						return false;
+					line.swap(m_buffer);
+					m_buffer.clear();
+					return true;
+				}
+				m_buffer.append(chunk, static_cast<std::size_t>(received));
+			}
+		}
+	};
+}
+
+// Immutable catalogue published by the server. Never modified after construction.
+struct CatalogueSnapshot {
+	ParticleCatalogue catalogue;
+	std::uint64_t version;
+};
+
+class CatalogueServer {
+public:
+	using Loader = std::function<ParticleCatalogue()>;
+
+private:
+	struct CachedResponse {
+		std::uint64_t version; // Snapshot the response was computed from
+		std::string text;
+	};
+
+	std::string m_path;
+	Loader m_loader;
+	std::shared_ptr<const CatalogueSnapshot> m_snapshot; // Accessed only through std::atomic_load/atomic_store
+	std::mutex m_reloadMutex;
+	LruCache<std::string, CachedResponse> m_cache;
+	std::atomic<bool> m_stop{false};
+	std::atomic<std::size_t> m_requests{0};
+	int m_listenFd = -1;
+
+	// Identity of the socket file this server created, so the destructor never removes a file that replaced it
+	bool m_bound = false;
+	dev_t m_socketDevice = 0;
+	ino_t m_socketInode = 0;
+
+	// Connection threads are detached; the destructor waits for this count to reach zero
+	std::mutex m_connectionsMutex;
+	std::condition_variable m_connectionsDone;
+	std::size_t m_activeConnections = 0;
+
+	std::shared_ptr<const CatalogueSnapshot> snapshot() const { return std::atomic_load(&m_snapshot); }
+
+	static bool isReload(std::string_view line) {
+		while(!line.empty() && (line.back() == '\r' || line.back() == ' '))
+			line.remove_suffix(1);
+		return line.size() == 6 && (line == "RELOAD" || line == "reload");
+	}
+
+	std::string answer(const std::string& line) {
+		m_requests.fetch_add(1, std::memory_order_relaxed);
+		if(isReload(line)) {
+			try {
+				std::uint64_t version = reload();
+				return "{\"query\":\"RELOAD\",\"result\":\"reloaded\",\"version\":" + std::to_string(version) + "}\n\n";
+			}
+			catch(const std::exception&) {
+				// Keep serving the previous snapshot
+				return "{\"query\":\"RELOAD\",\"result\":\"error\",\"version\":" + std::to_string(version()) + "}\n\n";
+			}
+		}
+
+		// Pin the current snapshot for the whole request
+		std::shared_ptr<const CatalogueSnapshot> current = snapshot();
+		CachedResponse cached;
+		if(m_cache.get(line, cached) && cached.version == current->version)
+			return cached.text;
+
+		QueryWriter writer(QueryFormat::JsonLines);
+		if(!CatalogueQuery::answer(current->catalogue, line, writer))
+			writer.writeFailure(line, "error");
+		std::string response = writer.buffer() + "\n";
+		if(CatalogueQuery::isCacheable(line))
+			m_cache.put(line, CachedResponse{current->version, response});
+		return response;
+	}
+
+	void serveConnection(int fd) {
+		socket_io::LineReader reader(fd, &m_stop);
+		std::string line;
+		while(!m_stop.load(std::memory_order_relaxed) && reader.next(line)) {
+			if(!socket_io::sendAll(fd, answer(line)))
+				break;
+		}
+		::close(fd);
+
+		std::lock_guard<std::mutex> lock(m_connectionsMutex);
+		if(--m_activeConnections == 0)
+			m_connectionsDone.notify_all();
+	}
+
+public:
+	CatalogueServer(std::string path, Loader loader, std::size_t cacheCapacity = 4096)
+		: m_path(std::move(path)), m_loader(std::move(loader)), m_cache(cacheCapacity) {
+		reload();
+	}
+
+	~CatalogueServer() {
+		stop();
+		std::unique_lock<std::mutex> lock(m_connectionsMutex);
+		m_connectionsDone.wait(lock, [this] { return m_activeConnections == 0; });
+		if(m_listenFd >= 0)
+			::close(m_listenFd);
+		struct stat status;
+		if(m_bound && ::lstat(m_path.c_str(), &status) == 0 && status.st_dev == m_socketDevice && status.st_ino == m_socketInode)
+			::unlink(m_path.c_str());
+	}
+
+	CatalogueServer(const CatalogueServer&) = delete;
+	CatalogueServer& operator=(const CatalogueServer&) = delete;
+
+	// Build a new snapshot and publish it; concurrent reloads are serialised. Returns the new version.
+	std::uint64_t reload() {
+		std::lock_guard<std::mutex> lock(m_reloadMutex);
+		std::shared_ptr<const CatalogueSnapshot> previous = snapshot();
+		auto next = std::make_shared<CatalogueSnapshot>(CatalogueSnapshot{m_loader(), previous ? previous->version + 1 : 1});
+		std::atomic_store(&m_snapshot, std::shared_ptr<const CatalogueSnapshot>(std::move(next)));
+		m_cache.clear();
+		return snapshot()->version;
+	}
+
+	std::uint64_t version() const { return snapshot()->version; }
+	std::size_t requests() const { return m_requests.load(std::memory_order_relaxed); }
+	std::size_t cacheHits() const { return m_cache.hits(); }
+	std::size_t cacheMisses() const { return m_cache.misses(); }
+
+	// Ask run() to return; safe to call from another thread
+	void stop() { m_stop.store(true); }
+
+	// Bind the socket and serve connections, one thread each, until stop() is called
+	void run() {
+		sockaddr_un addr = socket_io::address(m_path);
+		m_listenFd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+		if(m_listenFd < 0)
+			throw std::runtime_error(std::string("socket() failed: ") + std::strerror(errno));
+		socket_io::removeStaleSocket(m_path);
+		if(::bind(m_listenFd, reinterpret_cast<const sockaddr*>(&addr), sizeof(addr)) < 0)
+			throw std::runtime_error("Cannot listen on '" + m_path + "': " + std::strerror(errno));
+		struct stat status;
+		if(::lstat(m_path.c_str(), &status) == 0) {
+			m_bound = true;
+			m_socketDevice = status.st_dev;
+			m_socketInode = status.st_ino;
+		}
+		if(::listen(m_listenFd, SOMAXCONN) < 0)
+			throw std::runtime_error("Cannot listen on '" + m_path + "': " + std::strerror(errno));
+
+		while(!m_stop.load()) {
+			// Wake up periodically to notice stop()
+			pollfd listener{m_listenFd, POLLIN, 0};
+			int ready = ::poll(&listener, 1, 200);
+			if(ready <= 0)
+				continue;
+			int client = ::accept(m_listenFd, nullptr, nullptr);
+			if(client < 0)
+				continue;
+
+			// A receive timeout lets connection threads notice stop() while a client is idle
+			timeval timeout{1, 0};
+			::setsockopt(client, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+
+			{
+				std::lock_guard<std::mutex> lock(m_connectionsMutex);
+				++m_activeConnections;
+			}
+			std::thread(&CatalogueServer::serveConnection, this, client).detach();
+		}
+	}
+};
+
+// Client side of the protocol: send one query and collect its response, without the terminating empty line
+class CatalogueClient {
+private:
+	int m_fd;
+	socket_io::LineReader m_reader;
+
+public:
+	explicit CatalogueClient(const std::string& path) : m_fd(::socket(AF_UNIX, SOCK_STREAM, 0)), m_reader(m_fd) {
+		if(m_fd < 0)
+			throw std::runtime_error(std::string("socket() failed: ") + std::strerror(errno));
+		sockaddr_un addr = socket_io::address(path);
+		if(::connect(m_fd, reinterpret_cast<const sockaddr*>(&addr), sizeof(addr)) < 0) {
+			int error = errno;
+			::close(m_fd);
+			throw std::runtime_error("Cannot connect to '" + path + "': " + std::strerror(error));
+		}
+	}
+
+	~CatalogueClient() { ::close(m_fd); }
+
+	CatalogueClient(const CatalogueClient&) = delete;
+	CatalogueClient& operator=(const CatalogueClient&) = delete;
+
+	std::string query(const std::string& line) {
+		if(line.find('\n') != std::string::npos)
+			throw std::invalid_argument("A query must be a single line.");
+		if(!socket_io::sendAll(m_fd, line + "\n"))
+			throw std::runtime_error("Connection to the catalogue server was lost.");
+
+		std::string response, record;
+		while(m_reader.next(record) && !record.empty())
+			response += record + "\n";
+		return response;
+	}
+};
+
+#endif // !_WIN32
+
+#endif // CATALOGUE_SERVER_HPP
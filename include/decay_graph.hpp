@@ -0,0 +1,292 @@
+// Project-2 - Luca Vicaria - PHYS30762
+// This file defines a flat decay graph for one event. Every particle of the event's decay chains becomes one node in
+// a contiguous array, linked by parent, first-child and next-sibling indices, with its kinematics and quantum numbers
+// stored inline so that walking the chain never dereferences a particle.
+// Each tree is stored in breadth-first order, so the children of a node and the descendants of a node at any depth
+// are contiguous. Depth-first, breadth-first and final-state traversals follow the indices without allocating.
+// Last modified 16/10/2026
+
+#ifndef DECAY_GRAPH_HPP
+#define DECAY_GRAPH_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <memory>
+#include <stdexcept>
+#include <vector>
+
+#include "particle.hpp"
+#include "four_momentum.hpp"
+
+struct DecayNode {
+	static constexpr std::int32_t NONE = -1;
+
+	const Particle* particle; // Not owned; valid while the event's particles are alive
+	double energy, px, py, pz;
+	int pdgId;
+	int chargeThirds;
+	std::int32_t parent;      // NONE for a root
+	std::int32_t firstChild;  // NONE for a final-state particle
+	std::int32_t nextSibling; // Roots are chained as siblings in the order they were added
+	std::uint16_t childCount;
+	std::uint16_t depth;      // 0 for a root
+
+	bool isFinalState() const { return firstChild == NONE; }
+	FourMomentum fourMomentum() const { return FourMomentum(energy, px, py, pz); }
+	double invariantMass() const { return fourMomentum().invariant_mass(); }
+};
+
+// Pre-order walk of a subtree, or of every tree in turn when started from the first root with no stop node
+class DepthFirstIterator {
+private:
+	const DecayNode* m_nodes = nullptr;
+	std::int32_t m_current = DecayNode::NONE;
+	std::int32_t m_stop = DecayNode::NONE; // Subtree root, whose siblings are not visited
+
+public:
+	using iterator_category = std::forward_iterator_tag;
+	using value_type = DecayNode;
+	using difference_type = std::ptrdiff_t;
+	using pointer = const DecayNode*;
+	using reference = const DecayNode&;
+
+	DepthFirstIterator() = default;
+	DepthFirstIterator(const DecayNode* nodes, std::int32_t current, std::int32_t stop) : m_nodes(nodes), m_current(current), m_stop(stop) {}
+
+	reference operator*() const { return m_nodes[m_current]; }
+	pointer operator->() const { return m_nodes + m_current; }
+	std::int32_t index() const { return m_current; }
+
+	DepthFirstIterator& operator++() {
+		if(m_nodes[m_current].firstChild != DecayNode::NONE) {
+			m_current = m_nodes[m_current].firstChild;
+			return *this;
+		}
+		// Climb until a node with an unvisited sibling, without leaving the subtree
+		while(m_current != DecayNode::NONE) {
+			if(m_current == m_stop) {
+				m_current = DecayNode::NONE;
+				break;
+			}
+			if(m_nodes[m_current].nextSibling != DecayNode::NONE) {
+				m_current = m_nodes[m_current].nextSibling;
+				break;
+			}
+			m_current = m_nodes[m_current].parent;
+		}
+		return *this;
+	}
+
+	DepthFirstIterator operator++(int) {
+		DepthFirstIterator previous = *this;
+		++*this;
+		return previous;
+	}
+
+	bool operator==(const DepthFirstIterator& other) const { return m_current == other.m_current; }
+	bool operator!=(const DepthFirstIterator& other) const { return m_current != other.m_current; }
+};
+
+// Level-by-level walk of a subtree. Because each tree is stored breadth first, the subtree's nodes at each depth are
+// one contiguous block, found from the first and last nodes with children in the block above.
+class BreadthFirstIterator {
+private:
+	const DecayNode* m_nodes = nullptr;
+	std::int32_t m_current = DecayNode::NONE;
+	std::int32_t m_levelEnd = DecayNode::NONE;
+	std::int32_t m_nextBegin = DecayNode::NONE;
+	std::int32_t m_nextEnd = DecayNode::NONE;
+
+public:
+	using iterator_category = std::forward_iterator_tag;
+	using value_type = DecayNode;
+	using difference_type = std::ptrdiff_t;
+	using pointer = const DecayNode*;
+	using reference = const DecayNode&;
+
+	BreadthFirstIterator() = default;
+	BreadthFirstIterator(const DecayNode* nodes, std::int32_t root) : m_nodes(nodes), m_current(root), m_levelEnd(root + 1) {}
+
+	reference operator*() const { return m_nodes[m_current]; }
+	pointer operator->() const { return m_nodes + m_current; }
+	std::int32_t index() const { return m_current; }
+
+	BreadthFirstIterator& operator++() {
+		const DecayNode& node = m_nodes[m_current];
+		if(node.firstChild != DecayNode::NONE) {
+			if(m_nextBegin == DecayNode::NONE)
+				m_nextBegin = node.firstChild;
+			m_nextEnd = node.firstChild + node.childCount;
+		}
+		if(++m_current == m_levelEnd) {
+			m_current = m_nextBegin;
+			m_levelEnd = m_nextEnd;
+			m_nextBegin = m_nextEnd = DecayNode::NONE;
+		}
+		return *this;
+	}
+
+	BreadthFirstIterator operator++(int) {
+		BreadthFirstIterator previous = *this;
+		++*this;
+		return previous;
+	}
+
+	bool operator==(const BreadthFirstIterator& other) const { return m_current == other.m_current; }
+	bool operator!=(const BreadthFirstIterator& other) const { return m_current != other.m_current; }
+};
+
+// Skips the nodes of an underlying walk that decayed, leaving the final-state particles
+template <typename Iterator>
+class FinalStateIterator {
+private:
+	Iterator m_current;
+	Iterator m_end;
+
+	void skip() {
+		while(m_current != m_end && !m_current->isFinalState())
+			++m_current;
+	}
+
+public:
+	using iterator_category = std::forward_iterator_tag;
+	using value_type = DecayNode;
+	using difference_type = std::ptrdiff_t;
+	using pointer = const DecayNode*;
+	using reference = const DecayNode&;
+
+	FinalStateIterator(Iterator current, Iterator end) : m_current(current), m_end(end) { skip(); }
+
+	reference operator*() const { return *m_current; }
+	pointer operator->() const { return &*m_current; }
+
+	FinalStateIterator& operator++() {
+		++m_current;
+		skip();
+		return *this;
+	}
+
+	FinalStateIterator operator++(int) {
+		FinalStateIterator previous = *this;
+		++*this;
+		return previous;
+	}
+
+	bool operator==(const FinalStateIterator& other) const { return m_current == other.m_current; }
+	bool operator!=(const FinalStateIterator& other) const { return m_current != other.m_current; }
+};
+
+template <typename Iterator>
+class NodeRange {
+private:
+	Iterator m_begin;
+	Iterator m_end;
+
+public:
+	NodeRange(Iterator begin, Iterator end) : m_begin(begin), m_end(end) {}
+	Iterator begin() const { return m_begin; }
+	Iterator end() const { return m_end; }
+	bool empty() const { return m_begin == m_end; }
+};
+
+class DecayGraph {
+private:
+	std::vector<DecayNode> m_nodes;
+	std::vector<std::int32_t> m_roots;
+
+	void appendNode(const Particle& particle, std::int32_t parent, std::int32_t nextSibling, std::uint16_t depth) {
+		const FourMomentum& momentum = particle.getFourMomentum();
+		m_nodes.push_back(DecayNode{&particle, momentum.get_energy(), momentum.get_px(), momentum.get_py(), momentum.get_pz(),
+		                            particle.getPdgId(), particle.getChargeThirds(), parent, DecayNode::NONE, nextSibling, 0, depth});
+	}
+
+public:
+	std::size_t size() const { return m_nodes.size(); }
+	bool empty() const { return m_nodes.empty(); }
+	const DecayNode& operator[](std::size_t index) const { return m_nodes[index]; }
+	const DecayNode* data() const { return m_nodes.data(); }
+	const std::vector<std::int32_t>& roots() const { return m_roots; }
+
+	void reserve(std::size_t nodes) { m_nodes.reserve(nodes); }
+
+	// Forget every node but keep the storage, so one graph can be reused for every event
+	void clear() {
+		m_nodes.clear();
+		m_roots.clear();
+	}
+
+	// Flatten the decay chain of root into the graph, breadth first, returning the root's index. The nodes already
+	// appended serve as the queue, so flattening does not allocate once the storage has grown.
+	std::int32_t add(const Particle& root) {
+		if(m_nodes.size() >= static_cast<std::size_t>(INT32_MAX))
+			throw std::length_error("Decay graph is full.");
+		const std::int32_t rootIndex = static_cast<std::int32_t>(m_nodes.size());
+		if(!m_roots.empty())
+			m_nodes[m_roots.back()].nextSibling = rootIndex;
+		m_roots.push_back(rootIndex);
+		appendNode(root, DecayNode::NONE, DecayNode::NONE, 0);
+
+		for(std::size_t index = rootIndex; index < m_nodes.size(); ++index) {
+			const std::vector<std::shared_ptr<Particle>>& daughters = m_nodes[index].particle->getDecayParticles();
+			if(daughters.empty())
+				continue;
+			if(daughters.size() > UINT16_MAX || m_nodes[index].depth == UINT16_MAX)
+				throw std::length_error("Decay chain is too wide or too deep for the decay graph.");
+			const std::int32_t first = static_cast<std::int32_t>(m_nodes.size());
+			m_nodes[index].firstChild = first;
+			m_nodes[index].childCount = static_cast<std::uint16_t>(daughters.size());
+			const std::uint16_t depth = static_cast<std::uint16_t>(m_nodes[index].depth + 1);
+			for(std::size_t k = 0; k < daughters.size(); ++k) {
+				const std::int32_t sibling = k + 1 < daughters.size() ? first + static_cast<std::int32_t>(k) + 1 : DecayNode::NONE;
+				appendNode(*daughters[k], static_cast<std::int32_t>(index), sibling, depth);
+			}
+		}
+		return rootIndex;
+	}
+
+	// The direct decay products of a node, which are contiguous
+	NodeRange<const DecayNode*> children(std::int32_t index) const {
+		const DecayNode& node = m_nodes[index];
+		const DecayNode* first = node.firstChild == DecayNode::NONE ? m_nodes.data() : m_nodes.data() + node.firstChild;
+		return {first, first + node.childCount};
+	}
+
+	// Pre-order walk of the subtree below and including a node
+	NodeRange<DepthFirstIterator> depthFirst(std::int32_t index) const {
+		return {DepthFirstIterator(m_nodes.data(), index, index), DepthFirstIterator(m_nodes.data(), DecayNode::NONE, index)};
+	}
+
+	// Pre-order walk of every tree in the order they were added
+	NodeRange<DepthFirstIterator> depthFirst() const {
+		const std::int32_t first = m_roots.empty() ? DecayNode::NONE : m_roots.front();
+		return {DepthFirstIterator(m_nodes.data(), first, DecayNode::NONE), DepthFirstIterator(m_nodes.data(), DecayNode::NONE, DecayNode::NONE)};
+	}
+
+	// Level-by-level walk of the subtree below and including a node
+	NodeRange<BreadthFirstIterator> breadthFirst(std::int32_t index) const {
+		return {BreadthFirstIterator(m_nodes.data(), index), BreadthFirstIterator(m_nodes.data(), DecayNode::NONE)};
+	}
+
+	// Every node in storage order, which is each tree in turn, breadth first
+	NodeRange<const DecayNode*> nodes() const {
+		return {m_nodes.data(), m_nodes.data() + m_nodes.size()};
+	}
+
+	// The particles that did not decay below a node, in depth-first order
+	NodeRange<FinalStateIterator<DepthFirstIterator>> finalState(std::int32_t index) const {
+		const NodeRange<DepthFirstIterator> walk = depthFirst(index);
+		return {FinalStateIterator<DepthFirstIterator>(walk.begin(), walk.end()), FinalStateIterator<DepthFirstIterator>(walk.end(), walk.end())};
+	}
+
+	// Every final-state particle of the event, in storage order
+	NodeRange<FinalStateIterator<const DecayNode*>> finalState() const {
+		const DecayNode* first = m_nodes.data();
+		const DecayNode* last = first + m_nodes.size();
+		return {FinalStateIterator<const DecayNode*>(first, last), FinalStateIterator<const DecayNode*>(last, last)};
+	}
+
+	std::int32_t indexOf(const DecayNode& node) const { return static_cast<std::int32_t>(&node - m_nodes.data()); }
+};
+
+#endif // DECAY_GRAPH_HPP
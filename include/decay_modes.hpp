@@ -0,0 +1,290 @@
+// Project-2 - Luca Vicaria - PHYS30762
+// This file defines the registry of allowed decay modes of the Tau, W, Z and Higgs, with their branching ratios.
+// Modes are listed for the particle; an anti-particle's modes are the charge conjugates. Each mode is identified
+// by a key packing the parent's and the sorted daughters' PDG IDs into one integer, and the keys are placed in a
+// perfect hash table built at compile time, so checking a decay costs one multiply and one compare.
+// DecayModeSampler draws a mode weighted by branching ratio in constant time with an alias table.
+// Last modified 16/10/2026
+
+#ifndef DECAY_MODES_HPP
+#define DECAY_MODES_HPP
+
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "particle.hpp"
+#include "alias_sampler.hpp"
+#include "random_service.hpp"
+
+struct DecayMode {
+	static constexpr std::size_t MAX_DAUGHTERS = 4;
+
+	int parentPdgId;                             // Always the particle, never the anti-particle
+	std::array<int, MAX_DAUGHTERS> daughters;    // PDG IDs in any order, unused entries 0
+	std::size_t daughterCount;
+	double branchingRatio;
+	std::string_view label;
+};
+
+// Grouped by parent. Branching ratios are the PDG values (Standard Model predictions for the Higgs at 125 GeV),
+// with the hadronic widths split into quark pairs and adjusted so that each parent's modes sum to one.
+inline constexpr std::array<DecayMode, 33> DECAY_MODES{{
+	{15, {11, -12, 16}, 3, 0.1782, "e- nu_e~ nu_tau"},
+	{15, {13, -14, 16}, 3, 0.1739, "mu- nu_mu~ nu_tau"},
+	{15, {1, -2, 16}, 3, 0.6190, "d u~ nu_tau"},
+	{15, {3, -2, 16}, 3, 0.0289, "s u~ nu_tau"},
+
+	{24, {-11, 12}, 2, 0.1082, "e+ nu_e"},
+	{24, {-13, 14}, 2, 0.1082, "mu+ nu_mu"},
+	{24, {-15, 16}, 2, 0.1082, "tau+ nu_tau"},
+	{24, {2, -1}, 2, 0.3205, "u d~"},
+	{24, {4, -3}, 2, 0.3202, "c s~"},
+	{24, {2, -3}, 2, 0.0171, "u s~"},
+	{24, {4, -1}, 2, 0.0170, "c d~"},
+	{24, {4, -5}, 2, 0.0006, "c b~"},
+
+	{23, {11, -11}, 2, 0.03363, "e- e+"},
+	{23, {13, -13}, 2, 0.03366, "mu- mu+"},
+	{23, {15, -15}, 2, 0.03370, "tau- tau+"},
+	{23, {12, -12}, 2, 0.066703, "nu_e nu_e~"},
+	{23, {14, -14}, 2, 0.066703, "nu_mu nu_mu~"},
+	{23, {16, -16}, 2, 0.066703, "nu_tau nu_tau~"},
+	{23, {2, -2}, 2, 0.1156, "u u~"},
+	{23, {4, -4}, 2, 0.1203, "c c~"},
+	{23, {1, -1}, 2, 0.1559, "d d~"},
+	{23, {3, -3}, 2, 0.1559, "s s~"},
+	{23, {5, -5}, 2, 0.1512, "b b~"},
+
+	{25, {5, -5}, 2, 0.5809, "b b~"},
+	{25, {24, -24}, 2, 0.2152, "W+ W-"},
+	{25, {21, 21}, 2, 0.0818, "g g"},
+	{25, {15, -15}, 2, 0.06256, "tau- tau+"},
+	{25, {4, -4}, 2, 0.02884, "c c~"},
+	{25, {23, 23}, 2, 0.02641, "Z Z"},
+	{25, {22, 22}, 2, 0.00227, "gamma gamma"},
+	{25, {23, 22}, 2, 0.001541, "Z gamma"},
+	{25, {13, -13}, 2, 0.0002171, "mu- mu+"},
+	{25, {3, -3}, 2, 0.00026, "s s~"}
+}};
+
+// The modes of one parent, a contiguous slice of DECAY_MODES
+struct DecayModeRange {
+	const DecayMode* first;
+	const DecayMode* last;
+
+	constexpr const DecayMode* begin() const { return first; }
+	constexpr const DecayMode* end() const { return last; }
+	constexpr std::size_t size() const { return static_cast<std::size_t>(last - first); }
+	constexpr bool empty() const { return first == last; }
+	constexpr std::size_t offset() const { return static_cast<std::size_t>(first - DECAY_MODES.data()); } // Index of the first mode
+};
+
+class DecayModeRegistry {
+private:
+	static constexpr std::size_t SLOT_BITS = 8;
+	static constexpr std::size_t SLOTS = std::size_t(1) << SLOT_BITS; // Power of two, well above the number of modes
+	static constexpr int MAX_ID = 25;                                  // Largest |PDG ID| that can appear in a key
+	static constexpr std::size_t ID_BITS = 6;                          // Holds ID + MAX_ID + 1, leaving 0 for unused
+
+	static constexpr bool isSelfConjugate(int pdgId) { return pdgId == 21 || pdgId == 22 || pdgId == 23 || pdgId == 25; }
+	static constexpr int conjugate(int pdgId) { return isSelfConjugate(pdgId) ? pdgId : -pdgId; }
+
+	// Parent in the lowest bits, then the daughters in ascending order. Returns 0 if an ID is out of range.
+	static constexpr std::uint32_t key(int parentPdgId, const int* daughterIds, std::size_t count) {
+		std::array<int, DecayMode::MAX_DAUGHTERS> sorted{};
+		for(std::size_t i = 0; i < count; ++i) {
+			int id = daughterIds[i];
+			if(id < -MAX_ID || id > MAX_ID)
+				return 0;
+			std::size_t j = i;
+			for(; j > 0 && sorted[j - 1] > id; --j)
+				sorted[j] = sorted[j - 1];
+			sorted[j] = id;
+		}
+		if(parentPdgId < -MAX_ID || parentPdgId > MAX_ID)
+			return 0;
+		std::uint32_t packed = static_cast<std::uint32_t>(parentPdgId + MAX_ID + 1);
+		for(std::size_t i = 0; i < count; ++i)
+			packed |= static_cast<std::uint32_t>(sorted[i] + MAX_ID + 1) << (ID_BITS * (i + 1));
+		return packed;
+	}
+
+	static constexpr std::size_t slotOf(std::uint32_t multiplier, std::uint32_t packed) {
+		return static_cast<std::size_t>(static_cast<std::uint32_t>(packed * multiplier) >> (32 - SLOT_BITS));
+	}
+
+	struct Table {
+		std::uint32_t multiplier = 0;
+		std::array<std::uint32_t, SLOTS> keys{};
+		std::array<std::int16_t, SLOTS> mode{}; // Index into DECAY_MODES, or -1 for an empty slot
+	};
+
+	// Search odd multipliers until every mode's key lands in its own slot. Runs entirely at compile time.
+	static constexpr Table build() {
+		Table table{};
+		for(std::uint32_t multiplier = 0x9E3779B1u; ; multiplier += 2) {
+			for(auto& entry : table.mode)
+				entry = -1;
+			bool fits = true;
+			for(std::size_t i = 0; i < DECAY_MODES.size() && fits; ++i) {
+				const std::uint32_t packed = key(DECAY_MODES[i].parentPdgId, DECAY_MODES[i].daughters.data(), DECAY_MODES[i].daughterCount);
+				const std::size_t slot = slotOf(multiplier, packed);
+				fits = table.mode[slot] < 0;
+				table.keys[slot] = packed;
+				table.mode[slot] = static_cast<std::int16_t>(i);
+			}
+			if(fits) {
+				table.multiplier = multiplier;
+				return table;
+			}
+		}
+	}
+
+	static const Table TABLE;
+
+	static constexpr int chargeThirds(int pdgId) {
+		const int id = pdgId < 0 ? -pdgId : pdgId;
+		const int charge = id <= 6 ? (id % 2 == 0 ? 2 : -1) : (id == 11 || id == 13 || id == 15) ? -3 : id == 24 ? 3 : 0;
+		return pdgId < 0 ? -charge : charge;
+	}
+
+	static constexpr int leptonNumber(int pdgId) {
+		const int id = pdgId < 0 ? -pdgId : pdgId;
+		return id >= 11 && id <= 16 ? (pdgId < 0 ? -1 : 1) : 0;
+	}
+
+	static constexpr int baryonThirds(int pdgId) {
+		const int id = pdgId < 0 ? -pdgId : pdgId;
+		return id >= 1 && id <= 6 ? (pdgId < 0 ? -1 : 1) : 0;
+	}
+
+public:
+	// Index into DECAY_MODES of the mode of parentPdgId with exactly these daughters, in any order, or -1.
+	// An anti-particle parent is matched through the charge conjugate of its decay.
+	static constexpr int find(int parentPdgId, const int* daughterIds, std::size_t count) {
+		if(count == 0 || count > DecayMode::MAX_DAUGHTERS)
+			return -1;
+		std::array<int, DecayMode::MAX_DAUGHTERS> ids{};
+		const bool anti = parentPdgId < 0 && !isSelfConjugate(-parentPdgId);
+		for(std::size_t i = 0; i < count; ++i)
+			ids[i] = anti ? conjugate(daughterIds[i]) : daughterIds[i];
+		const std::uint32_t packed = key(anti ? -parentPdgId : parentPdgId, ids.data(), count);
+		if(packed == 0)
+			return -1;
+		const std::size_t slot = slotOf(TABLE.multiplier, packed);
+		return TABLE.mode[slot] >= 0 && TABLE.keys[slot] == packed ? TABLE.mode[slot] : -1;
+	}
+
+	static int find(const Particle& parent, const std::vector<std::shared_ptr<Particle>>& daughters) {
+		if(daughters.empty() || daughters.size() > DecayMode::MAX_DAUGHTERS)
+			return -1;
+		std::array<int, DecayMode::MAX_DAUGHTERS> ids{};
+		for(std::size_t i = 0; i < daughters.size(); ++i)
+			ids[i] = daughters[i]->getPdgId();
+		return find(parent.getPdgId(), ids.data(), daughters.size());
+	}
+
+	static bool isAllowed(const Particle& parent, const std::vector<std::shared_ptr<Particle>>& daughters) {
+		return find(parent, daughters) >= 0;
+	}
+
+	// PDG ID of daughter i when the mode is the decay of parentPdgId, charge conjugated for an anti-particle parent
+	static constexpr int daughterOf(const DecayMode& mode, std::size_t i, int parentPdgId) {
+		return parentPdgId < 0 && !isSelfConjugate(-parentPdgId) ? conjugate(mode.daughters[i]) : mode.daughters[i];
+	}
+
+	// Every registered mode of a particle, empty if it has none. An anti-particle shares its particle's modes.
+	static constexpr DecayModeRange modesOf(int parentPdgId) {
+		const int particle = parentPdgId < 0 ? -parentPdgId : parentPdgId;
+		const DecayMode* first = DECAY_MODES.data();
+		const DecayMode* last = first + DECAY_MODES.size();
+		while(first != last && first->parentPdgId != particle)
+			++first;
+		const DecayMode* end = first;
+		while(end != last && end->parentPdgId == particle)
+			++end;
+		return {first, end};
+	}
+
+	// Compile-time checks of the table: no mode breaks a conservation law and each parent's ratios sum to one
+	static constexpr bool conservesQuantumNumbers(const DecayMode& mode) {
+		int charge = 0, lepton = 0, baryon = 0;
+		for(std::size_t i = 0; i < mode.daughterCount; ++i) {
+			charge += chargeThirds(mode.daughters[i]);
+			lepton += leptonNumber(mode.daughters[i]);
+			baryon += baryonThirds(mode.daughters[i]);
+		}
+		return charge == chargeThirds(mode.parentPdgId) && lepton == leptonNumber(mode.parentPdgId) && baryon == 0;
+	}
+
+	static constexpr bool isConsistent() {
+		for(const DecayMode& mode : DECAY_MODES) {
+			if(!conservesQuantumNumbers(mode) || mode.branchingRatio <= 0.0)
+				return false;
+			double total = 0.0;
+			for(const DecayMode& sibling : modesOf(mode.parentPdgId))
+				total += sibling.branchingRatio;
+			if(total < 0.9999 || total > 1.0001)
+				return false;
+		}
+		return true;
+	}
+};
+
+// Draws the decay mode of one particle, weighted by branching ratio. Channels are numbered by their position in
+// DecayModeRegistry::modesOf(parent), so a batch of draws can be stored as small integers.
+class DecayModeSampler {
+private:
+	DecayModeRange m_modes{nullptr, nullptr};
+	AliasSampler m_sampler;
+
+	explicit DecayModeSampler(DecayModeRange modes) : m_modes(modes) {
+		std::vector<double> weights;
+		for(const DecayMode& mode : modes)
+			weights.push_back(mode.branchingRatio);
+		m_sampler = AliasSampler(weights);
+	}
+
+public:
+	// The shared sampler of a particle or anti-particle, built on first use
+	static const DecayModeSampler& of(int parentPdgId) {
+		static const std::vector<DecayModeSampler> samplers = [] {
+			std::vector<DecayModeSampler> all;
+			for(const DecayMode& mode : DECAY_MODES) {
+				if(all.empty() || all.back().m_modes.first->parentPdgId != mode.parentPdgId)
+					all.push_back(DecayModeSampler(DecayModeRegistry::modesOf(mode.parentPdgId)));
+			}
+			return all;
+		}();
+		const int particle = parentPdgId < 0 ? -parentPdgId : parentPdgId;
+		for(const DecayModeSampler& sampler : samplers) {
+			if(sampler.m_modes.first->parentPdgId == particle)
+				return sampler;
+		}
+		throw std::invalid_argument("No decay modes are registered for PDG ID " + std::to_string(parentPdgId) + ".");
+	}
+
+	const DecayModeRange& modes() const { return m_modes; }
+	const DecayMode& mode(std::uint32_t channel) const { return m_modes.first[channel]; }
+
+	std::uint32_t sampleChannel(PhiloxEngine& engine) const { return m_sampler.sample(engine); }
+	const DecayMode& sample(PhiloxEngine& engine) const { return mode(sampleChannel(engine)); }
+
+	// Fill channels[0..n) with independent draws
+	void sample(PhiloxEngine& engine, std::uint32_t* channels, std::size_t n) const { m_sampler.sample(engine, channels, n); }
+};
+
+inline constexpr DecayModeRegistry::Table DecayModeRegistry::TABLE = DecayModeRegistry::build();
+
+static_assert(DecayModeRegistry::isConsistent(), "Decay mode table breaks a conservation law or its branching ratios do not sum to one");
+static_assert(DecayModeRegistry::find(-24, std::array<int, 2>{11, -12}.data(), 2) >= 0 && DecayModeRegistry::find(23, std::array<int, 2>{11, 11}.data(), 2) < 0,
+              "Decay mode lookup is inconsistent");
+
+#endif // DECAY_MODES_HPP
@@ -0,0 +1,229 @@
+// Project-2 - Luca Vicaria - PHYS30762
+// This file defines a batch validator for decays which checks charge, lepton number, baryon number and
+// four-momentum conservation for many (parent, daughters) records at once.
+// Quantum numbers are held as integers (charge and baryon number in thirds) in flat columns, and results are
+// returned as a violation bitmask per record instead of being printed.
+// Last modified 16/10/2026
+
+#ifndef DECAY_VALIDATOR_HPP
+#define DECAY_VALIDATOR_HPP
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#if defined(__AVX2__) || defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+#include "particle.hpp"
+#include "four_momentum_batch.hpp"
+#include "metrics.hpp"
+#include "trace.hpp"
+
+// Bits of the per-record violation mask
+enum class DecayViolation : std::uint8_t {
+	Charge = 1 << 0,
+	LeptonNumber = 1 << 1,
+	BaryonNumber = 1 << 2,
+	FourMomentum = 1 << 3
+};
+
+inline bool hasViolation(std::uint8_t mask, DecayViolation violation) {
+	return (mask & static_cast<std::uint8_t>(violation)) != 0;
+}
+
+// Conserved quantum numbers of one particle in integer form
+struct QuantumNumbers {
+	int chargeThirds;
+	int leptonNumber;
+	int baryonThirds;
+
+	static QuantumNumbers of(const Particle& particle) {
+		return {particle.getChargeThirds(), particle.getLeptonNumber(), particle.getBaryonNumberThirds()};
+	}
+};
+
+// Flat store of decay records: one row per parent and one row per daughter, with m_offsets
+// giving the range of daughter rows that belongs to each parent
+class DecayBatch {
+private:
+	std::vector<int> m_parentCharge, m_parentLepton, m_parentBaryon;
+	std::vector<int> m_daughterCharge, m_daughterLepton, m_daughterBaryon;
+	FourMomentumBatch m_parentMomenta;
+	FourMomentumBatch m_daughterMomenta;
+	std::vector<std::uint32_t> m_offsets{0};
+
+	void addDaughter(const QuantumNumbers& numbers, const FourMomentum& momentum) {
+		m_daughterCharge.push_back(numbers.chargeThirds);
+		m_daughterLepton.push_back(numbers.leptonNumber);
+		m_daughterBaryon.push_back(numbers.baryonThirds);
+		m_daughterMomenta.push_back(momentum);
+	}
+
+	void addParent(const QuantumNumbers& numbers, const FourMomentum& momentum) {
+		m_parentCharge.push_back(numbers.chargeThirds);
+		m_parentLepton.push_back(numbers.leptonNumber);
+		m_parentBaryon.push_back(numbers.baryonThirds);
+		m_parentMomenta.push_back(momentum);
+	}
+
+public:
+	std::size_t size() const { return m_parentCharge.size(); }
+	std::size_t daughterCount() const { return m_daughterCharge.size(); }
+
+	void reserve(std::size_t records, std::size_t daughtersPerRecord = 3) {
+		m_parentCharge.reserve(records);
+		m_parentLepton.reserve(records);
+		m_parentBaryon.reserve(records);
+		m_parentMomenta.reserve(records);
+		m_daughterCharge.reserve(records * daughtersPerRecord);
+		m_daughterLepton.reserve(records * daughtersPerRecord);
+		m_daughterBaryon.reserve(records * daughtersPerRecord);
+		m_daughterMomenta.reserve(records * daughtersPerRecord);
+		m_offsets.reserve(records + 1);
+	}
+
+	void clear() {
+		*this = DecayBatch();
+	}
+
+	// Append a record from already extracted quantum numbers and momenta
+	void add(const QuantumNumbers& parent, const FourMomentum& parentMomentum,
+	         const QuantumNumbers* daughters, const FourMomentum* daughterMomenta, std::size_t nDaughters) {
+		addParent(parent, parentMomentum);
+		for(std::size_t i = 0; i < nDaughters; ++i)
+			addDaughter(daughters[i], daughterMomenta[i]);
+		m_offsets.push_back(static_cast<std::uint32_t>(m_daughterCharge.size()));
+	}
+
+	// Append a record from particle objects. The virtual getters are called once here rather than per check.
+	void add(const Particle& parent, const std::vector<std::shared_ptr<Particle>>& daughters) {
+		addParent(QuantumNumbers::of(parent), parent.getFourMomentum());
+		for(const auto& daughter : daughters)
+			addDaughter(QuantumNumbers::of(*daughter), daughter->getFourMomentum());
+		m_offsets.push_back(static_cast<std::uint32_t>(m_daughterCharge.size()));
+	}
+
+	void add(const Particle& parent) { add(parent, parent.getDecayParticles()); }
+
+	friend class DecayValidator;
+};
+
+class DecayValidator {
+private:
+	double m_relativeTolerance;
+	double m_absoluteTolerance;
+
+	// Set the FourMomentum bit for every record whose summed daughter momentum differs from the parent's
+	// by more than absolute + relative * parent energy in any component
+	void checkMomenta(std::size_t n, const double* const* parent, const double* const* sum, const double* parentEnergy, std::uint8_t* out) const {
+		const std::uint8_t bit = static_cast<std::uint8_t>(DecayViolation::FourMomentum);
+		std::size_t r = 0;
+#if defined(__AVX2__)
+		const __m256d signMask = _mm256_set1_pd(-0.0);
+		const __m256d absTol = _mm256_set1_pd(m_absoluteTolerance);
+		const __m256d relTol = _mm256_set1_pd(m_relativeTolerance);
+		for(; r + 4 <= n; r += 4) {
+			__m256d tolerance = _mm256_add_pd(absTol, _mm256_mul_pd(relTol, _mm256_andnot_pd(signMask, _mm256_loadu_pd(parentEnergy + r))));
+			__m256d bad = _mm256_setzero_pd();
+			for(int c = 0; c < 4; ++c) {
+				__m256d residual = _mm256_andnot_pd(signMask, _mm256_sub_pd(_mm256_loadu_pd(sum[c] + r), _mm256_loadu_pd(parent[c] + r)));
+				bad = _mm256_or_pd(bad, _mm256_cmp_pd(residual, tolerance, _CMP_GT_OQ));
+			}
+			int lanes = _mm256_movemask_pd(bad);
+			for(int lane = 0; lane < 4; ++lane)
+				out[r + lane] |= (lanes >> lane) & 1 ? bit : 0;
+		}
+#elif defined(__SSE2__)
+		const __m128d signMask = _mm_set1_pd(-0.0);
+		const __m128d absTol = _mm_set1_pd(m_absoluteTolerance);
+		const __m128d relTol = _mm_set1_pd(m_relativeTolerance);
+		for(; r + 2 <= n; r += 2) {
+			__m128d tolerance = _mm_add_pd(absTol, _mm_mul_pd(relTol, _mm_andnot_pd(signMask, _mm_loadu_pd(parentEnergy + r))));
+			__m128d bad = _mm_setzero_pd();
+			for(int c = 0; c < 4; ++c) {
+				__m128d residual = _mm_andnot_pd(signMask, _mm_sub_pd(_mm_loadu_pd(sum[c] + r), _mm_loadu_pd(parent[c] + r)));
+				bad = _mm_or_pd(bad, _mm_cmpgt_pd(residual, tolerance));
+			}
+			int lanes = _mm_movemask_pd(bad);
+			for(int lane = 0; lane < 2; ++lane)
+				out[r + lane] |= (lanes >> lane) & 1 ? bit : 0;
+		}
+#endif
+		for(; r < n; ++r) {
+			double tolerance = m_absoluteTolerance + m_relativeTolerance * std::abs(parentEnergy[r]);
+			for(int c = 0; c < 4; ++c) {
+				if(std::abs(sum[c][r] - parent[c][r]) > tolerance)
+					out[r] |= bit;
+			}
+		}
+	}
+
+public:
+	// Tolerances for four-momentum conservation: absolute in MeV plus a fraction of the parent energy
+	explicit DecayValidator(double relativeTolerance = 1e-9, double absoluteTolerance = 1e-6)
+		: m_relativeTolerance(relativeTolerance), m_absoluteTolerance(absoluteTolerance) {}
+
+	// Validate every record, writing one violation mask per record to out[0..batch.size())
+	void validate(const DecayBatch& batch, std::uint8_t* out) const {
+		METRICS_TIME(DecayBatchValidationNs);
+		TRACE_SPAN_ARG("DecayValidator::validate", "validation", batch.size());
+		const std::size_t n = batch.size();
+		std::vector<int> charge(n, 0), lepton(n, 0), baryon(n, 0);
+		FourMomentumBatch sums(n);
+
+		// Segmented sums of the daughter columns, one segment per record
+		const double* de = batch.m_daughterMomenta.energy_data();
+		const double* dx = batch.m_daughterMomenta.px_data();
+		const double* dy = batch.m_daughterMomenta.py_data();
+		const double* dz = batch.m_daughterMomenta.pz_data();
+		double* se = sums.energy_data();
+		double* sx = sums.px_data();
+		double* sy = sums.py_data();
+		double* sz = sums.pz_data();
+		for(std::size_t r = 0; r < n; ++r) {
+			for(std::uint32_t d = batch.m_offsets[r]; d < batch.m_offsets[r + 1]; ++d) {
+				charge[r] += batch.m_daughterCharge[d];
+				lepton[r] += batch.m_daughterLepton[d];
+				baryon[r] += batch.m_daughterBaryon[d];
+				se[r] += de[d];
+				sx[r] += dx[d];
+				sy[r] += dy[d];
+				sz[r] += dz[d];
+			}
+		}
+
+		// Branch-free integer comparisons, vectorised by the compiler
+		const int* pc = batch.m_parentCharge.data();
+		const int* pl = batch.m_parentLepton.data();
+		const int* pb = batch.m_parentBaryon.data();
+		for(std::size_t r = 0; r < n; ++r) {
+			out[r] = static_cast<std::uint8_t>((charge[r] != pc[r]) * static_cast<int>(DecayViolation::Charge)
+			                                 | (lepton[r] != pl[r]) * static_cast<int>(DecayViolation::LeptonNumber)
+			                                 | (baryon[r] != pb[r]) * static_cast<int>(DecayViolation::BaryonNumber));
+		}
+
+		const double* parent[4] = {batch.m_parentMomenta.energy_data(), batch.m_parentMomenta.px_data(), batch.m_parentMomenta.py_data(), batch.m_parentMomenta.pz_data()};
+		const double* sum[4] = {se, sx, sy, sz};
+		checkMomenta(n, parent, sum, parent[0], out);
+
+#if !defined(PARTICLE_NO_METRICS)
+		std::size_t violations = 0;
+		for(std::size_t r = 0; r < n; ++r)
+			violations += out[r] != 0;
+		METRICS_ADD(DecayBatchRecords, n);
+		METRICS_ADD(DecayBatchViolations, violations);
+#endif
+	}
+
+	std::vector<std::uint8_t> validate(const DecayBatch& batch) const {
+		std::vector<std::uint8_t> masks(batch.size());
+		validate(batch, masks.data());
+		return masks;
+	}
+};
+
+#endif // DECAY_VALIDATOR_HPP
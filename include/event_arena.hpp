@@ -0,0 +1,152 @@
+// Project-2 - Luca Vicaria - PHYS30762
+// This file defines an event-scoped bump allocator for particles and four-momenta.
+// Objects created through makeEventShared while an EventScope is active are placed in the bound arena,
+// and the whole arena is released in O(1) once the event has been processed.
+// Last modified 16/10/2026
+
+#ifndef EVENT_ARENA_HPP
+#define EVENT_ARENA_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include "metrics.hpp"
+
+class EventArena {
+private:
+	struct Block {
+		std::unique_ptr<unsigned char[]> memory;
+		std::size_t size;
+	};
+
+	std::vector<Block> m_blocks;
+	std::size_t m_blockSize;
+	std::size_t m_currentBlock = 0;
+	std::size_t m_offset = 0;
+	// Atomic because a shared_ptr copied out of the event may be released on another thread, e.g. a pool worker
+	std::atomic<std::size_t> m_liveAllocations{0};
+	std::size_t m_bytesAllocated = 0;
+	std::size_t m_allocations = 0; // Since the last reset, reported to the metrics registry in bulk
+
+	void addBlock(std::size_t minimumSize) {
+		std::size_t size = minimumSize > m_blockSize ? minimumSize : m_blockSize;
+		m_blocks.push_back({std::unique_ptr<unsigned char[]>(new unsigned char[size]), size});
+		METRICS_INCREMENT(ArenaBlocks);
+	}
+
+public:
+	explicit EventArena(std::size_t blockSize = 64 * 1024) : m_blockSize(blockSize) { addBlock(blockSize); }
+
+	// The arena owns raw storage that objects point into, so it cannot be copied or moved
+	EventArena(const EventArena&) = delete;
+	EventArena& operator=(const EventArena&) = delete;
+
+	~EventArena() {}
+
+	// Bump-allocate from the current block, moving on to (or creating) the next block when it is full
+	void* allocate(std::size_t bytes, std::size_t alignment) {
+		while(true) {
+			Block& block = m_blocks[m_currentBlock];
+			std::size_t aligned = (m_offset + alignment - 1) & ~(alignment - 1);
+			if(aligned + bytes <= block.size) {
+				m_offset = aligned + bytes;
+				m_liveAllocations.fetch_add(1, std::memory_order_relaxed);
+				m_bytesAllocated += bytes;
+				++m_allocations;
+				return block.memory.get() + aligned;
+			}
+
+			// Blocks kept from earlier events are reused before new ones are created
+			++m_currentBlock;
+			m_offset = 0;
+			if(m_currentBlock == m_blocks.size())
+				addBlock(bytes + alignment);
+		}
+	}
+
+	// Individual deallocations only update the bookkeeping, the memory is reclaimed by reset(). May be called from
+	// any thread; the release pairs with the acquire in reset() so the object's destruction happens before its reuse.
+	void deallocate(void*, std::size_t) noexcept { m_liveAllocations.fetch_sub(1, std::memory_order_release); }
+
+	// Release every allocation at once, on the thread that allocates from the arena. All objects placed in the
+	// arena must already have been destroyed.
+	void reset() {
+		if(m_liveAllocations.load(std::memory_order_acquire) != 0)
+			throw std::logic_error("EventArena reset while objects allocated from it are still alive.");
+		METRICS_ADD(ArenaAllocations, m_allocations);
+		METRICS_ADD(ArenaBytes, m_bytesAllocated);
+		m_currentBlock = 0;
+		m_offset = 0;
+		m_bytesAllocated = 0;
+		m_allocations = 0;
+	}
+
+	std::size_t liveAllocations() const { return m_liveAllocations.load(std::memory_order_acquire); }
+	std::size_t bytesAllocated() const { return m_bytesAllocated; }
+	std::size_t capacity() const {
+		std::size_t total = 0;
+		for(const auto& block : m_blocks)
+			total += block.size;
+		return total;
+	}
+};
+
+// Standard allocator adaptor so std::allocate_shared can place the object and its control block in an arena
+template <typename T>
+class ArenaAllocator {
+private:
+	EventArena* m_arena;
+
+	template <typename U>
+	friend class ArenaAllocator;
+
+public:
+	using value_type = T;
+
+	explicit ArenaAllocator(EventArena* arena) noexcept : m_arena(arena) {}
+	template <typename U>
+	ArenaAllocator(const ArenaAllocator<U>& other) noexcept : m_arena(other.m_arena) {}
+
+	T* allocate(std::size_t n) { return static_cast<T*>(m_arena->allocate(n * sizeof(T), alignof(T))); }
+	void deallocate(T* pointer, std::size_t n) noexcept { m_arena->deallocate(pointer, n * sizeof(T)); }
+
+	template <typename U>
+	bool operator==(const ArenaAllocator<U>& other) const noexcept { return m_arena == other.m_arena; }
+	template <typename U>
+	bool operator!=(const ArenaAllocator<U>& other) const noexcept { return m_arena != other.m_arena; }
+};
+
+// Arena used by makeEventShared on the calling thread, or nullptr for the global heap
+inline EventArena*& currentEventArena() {
+	thread_local EventArena* arena = nullptr;
+	return arena;
+}
+
+// Binds an arena to the calling thread for the lifetime of the scope. Scopes may be nested.
+class EventScope {
+private:
+	EventArena* m_previous;
+
+public:
+	explicit EventScope(EventArena& arena) : m_previous(currentEventArena()) { currentEventArena() = &arena; }
+	~EventScope() { currentEventArena() = m_previous; }
+
+	EventScope(const EventScope&) = delete;
+	EventScope& operator=(const EventScope&) = delete;
+};
+
+// Arena-aware replacement for std::make_shared. Outside an EventScope it falls back to std::make_shared,
+// so the returned shared_ptr behaves the same either way; inside one it must not outlive the arena's next reset().
+template <typename T, typename... Args>
+std::shared_ptr<T> makeEventShared(Args&&... args) {
+	if(EventArena* arena = currentEventArena())
+		return std::allocate_shared<T>(ArenaAllocator<T>(arena), std::forward<Args>(args)...);
+	return std::make_shared<T>(std::forward<Args>(args)...);
+}
+
+#endif // EVENT_ARENA_HPP
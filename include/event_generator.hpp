@@ -0,0 +1,260 @@
+// Project-2 - Luca Vicaria - PHYS30762
+// This file defines the Monte Carlo event generator which produces Tau, W, Z and Higgs decays in parallel.
+// Every event draws from its own random stream and allocates from its worker's event arena, so the output
+// depends only on the global seed and the event number, never on the number of threads.
+// Last modified 16/10/2026
+
+#ifndef EVENT_GENERATOR_HPP
+#define EVENT_GENERATOR_HPP
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "particle.hpp"
+#include "leptons.hpp"
+#include "quarks.hpp"
+#include "bosons.hpp"
+#include "decay_modes.hpp"
+#include "event_arena.hpp"
+#include "metrics.hpp"
+#include "phase_space.hpp"
+#include "random_service.hpp"
+#include "thread_pool.hpp"
+#include "trace.hpp"
+
+enum class EventKind { Tau, W, Z, Higgs };
+
+// Compact per-event record kept after the event's particles have been released
+struct EventSummary {
+	EventKind kind;
+	bool isAntiParticle;
+	bool chargeConserved;
+	std::uint8_t daughterCount;
+	int daughterChargeThirds;
+	double daughterMassSum; // Sum of the daughters' invariant masses in MeV, so a virtual boson counts at its generated mass
+};
+
+struct GeneratorReport {
+	std::size_t events = 0;
+	std::size_t threads = 0;
+	double seconds = 0.0;
+	double eventsPerSecond = 0.0;
+	std::array<std::size_t, 4> eventsOfKind{};
+	std::size_t chargeViolations = 0;
+	std::uint64_t checksum = 0; // Hash of each chunk's summaries in event order, combined in chunk order, identical for any thread count
+};
+
+class EventGenerator {
+private:
+	std::size_t m_threads;
+	std::size_t m_grain;
+
+	// Daughter factories, allocating from the current event arena
+	static std::shared_ptr<Particle> lepton(LeptonType type, const FourMomentum& momentum, bool anti) {
+		if(type == LeptonType::Electron)
+			return makeEventShared<Electron>(momentum, anti);
+		if(type == LeptonType::Tau)
+			return makeEventShared<Tau>(momentum, anti);
+		return makeEventShared<Muon>(momentum, anti);
+	}
+
+	static std::shared_ptr<Particle> quark(QuarkType type, const FourMomentum& momentum, bool anti) {
+		return makeEventShared<Quark>(type, anti ? ColourCharge::AntiRed : ColourCharge::Red, momentum, anti);
+	}
+
+	// Rest mass of a daughter, from its PDG ID
+	static double daughterMass(int pdgId) {
+		const int id = pdgId < 0 ? -pdgId : pdgId;
+		switch(id) {
+			case 11: return ParticlePropertyTable<LeptonType>::get(LeptonType::Electron).mass;
+			case 13: return ParticlePropertyTable<LeptonType>::get(LeptonType::Muon).mass;
+			case 15: return ParticlePropertyTable<LeptonType>::get(LeptonType::Tau).mass;
+			case 12: case 14: case 16: case 21: case 22: return 0.0;
+			case 23: return ParticlePropertyTable<BosonType>::get(BosonType::Z).mass;
+			case 24: return ParticlePropertyTable<BosonType>::get(BosonType::W).mass;
+			default: return ParticlePropertyTable<QuarkType>::get(Quark::typeOfPdgId(id)).mass;
+		}
+	}
+
+	// Daughter i of a decay, from its PDG ID. A pair of gluons is given matching colours.
+	static std::shared_ptr<Particle> daughter(int pdgId, std::size_t i, const FourMomentum& momentum) {
+		const bool anti = pdgId < 0;
+		const int id = anti ? -pdgId : pdgId;
+		switch(id) {
+			case 11: return lepton(LeptonType::Electron, momentum, anti);
+			case 13: return lepton(LeptonType::Muon, momentum, anti);
+			case 15: return lepton(LeptonType::Tau, momentum, anti);
+			case 12: case 14: case 16: return makeEventShared<Neutrino>(static_cast<NeutrinoType>((id - 12) / 2), momentum, anti, false);
+			case 21: return i == 0 ? makeEventShared<Gluon>(momentum, ColourCharge::Red, ColourCharge::AntiGreen)
+			                       : makeEventShared<Gluon>(momentum, ColourCharge::Green, ColourCharge::AntiRed);
+			case 22: return makeEventShared<Photon>(momentum);
+			case 23: return makeEventShared<ZBoson>(momentum);
+			case 24: return makeEventShared<WBoson>(momentum, anti);
+			default: return quark(Quark::typeOfPdgId(id), momentum, anti);
+		}
+	}
+
+	// Every registered W, Z and Higgs mode is two-body, matching decay()
+	static_assert([] {
+		for(int parent : {24, 23, 25}) {
+			for(const DecayMode& mode : DecayModeRegistry::modesOf(parent)) {
+				if(mode.daughterCount != 2)
+					return false;
+			}
+		}
+		return true;
+	}(), "EventGenerator::decay expects two-body boson decays");
+
+	// Decay channel drawn from the registered modes, weighted by branching ratio, with the parent's four-momentum
+	// shared between the daughters by two-body phase space. Where the daughters' rest masses add up to more than the
+	// parent's, as in H -> W W and H -> Z Z, the second daughter is virtual: its mass is drawn uniformly below the
+	// energy left by the first, so the event still conserves four-momentum.
+	static std::vector<std::shared_ptr<Particle>> decay(const Particle& parent, PhiloxEngine& stream) {
+		const int parentPdgId = parent.getPdgId();
+		const DecayMode& mode = DecayModeSampler::of(parentPdgId).sample(stream);
+		const std::array<int, 2> ids{DecayModeRegistry::daughterOf(mode, 0, parentPdgId), DecayModeRegistry::daughterOf(mode, 1, parentPdgId)};
+		const FourMomentum& momentum = parent.getFourMomentum();
+
+		std::array<double, 2> masses{daughterMass(ids[0]), daughterMass(ids[1])};
+		const double parentMass = momentum.invariant_mass();
+		if(masses[0] + masses[1] >= parentMass)
+			masses[1] = (parentMass - masses[0]) * stream.uniform();
+
+		std::array<FourMomentum, 2> momenta;
+		PhaseSpaceGenerator{masses[0], masses[1]}.generate(momentum, stream, momenta.data());
+
+		std::vector<std::shared_ptr<Particle>> daughters;
+		daughters.reserve(2);
+		for(std::size_t i = 0; i < 2; ++i)
+			daughters.push_back(daughter(ids[i], i, momenta[i]));
+		return daughters;
+	}
+
+	static EventSummary summarise(EventKind kind, const Particle& parent) {
+		EventSummary summary{kind, parent.isAntiParticle(), false, 0, 0, 0.0};
+		for(const auto& daughter : parent.getDecayParticles()) {
+			++summary.daughterCount;
+			summary.daughterChargeThirds += daughter->getChargeThirds();
+			summary.daughterMassSum += daughter->getFourMomentum().invariant_mass();
+		}
+		summary.chargeConserved = summary.daughterChargeThirds == parent.getChargeThirds();
+		return summary;
+	}
+
+	static constexpr std::uint64_t HASH_SEED = 0xCBF29CE484222325ull;
+
+	static std::uint64_t mix(std::uint64_t hash, std::uint64_t value) {
+		// FNV-1a over the 8 bytes of value
+		for(int i = 0; i < 8; ++i) {
+			hash ^= (value >> (8 * i)) & 0xFF;
+			hash *= 0x100000001B3ull;
+		}
+		return hash;
+	}
+
+	// Counts and hash of one parallelFor chunk of events, so a run keeps one of these per chunk rather than per event
+	struct ChunkTotals {
+		std::array<std::size_t, 4> eventsOfKind{};
+		std::size_t chargeViolations = 0;
+		std::uint64_t hash = HASH_SEED;
+
+		void add(const EventSummary& summary) {
+			++eventsOfKind[static_cast<std::size_t>(summary.kind)];
+			if(!summary.chargeConserved)
+				++chargeViolations;
+			std::uint64_t massBits;
+			std::memcpy(&massBits, &summary.daughterMassSum, sizeof(massBits));
+			hash = mix(hash, static_cast<std::uint64_t>(summary.kind) | (std::uint64_t(summary.isAntiParticle) << 8) | (std::uint64_t(summary.daughterCount) << 16));
+			hash = mix(hash, static_cast<std::uint64_t>(static_cast<std::int64_t>(summary.daughterChargeThirds)));
+			hash = mix(hash, massBits);
+		}
+	};
+
+public:
+	explicit EventGenerator(std::size_t threads = std::thread::hardware_concurrency(), std::size_t grain = 1024)
+		: m_threads(threads == 0 ? 1 : threads), m_grain(grain == 0 ? 1 : grain) {}
+
+	// Generate a single event. The caller is expected to have bound the event's random stream and arena.
+	static EventSummary generateEvent(PhiloxEngine& stream) {
+		const EventKind kind = static_cast<EventKind>(stream() % 4);
+		const bool anti = (stream() & 1) != 0;
+
+		switch(kind) {
+			case EventKind::Tau: {
+				auto tau = makeEventShared<Tau>(FourMomentum(1776.8, 0, 0, 0), anti);
+				return summarise(kind, *tau);
+			}
+			case EventKind::W: {
+				auto w = makeEventShared<WBoson>(FourMomentum(80360, 0, 0, 0), anti);
+				w->setDecayParticles(decay(*w, stream));
+				return summarise(kind, *w);
+			}
+			case EventKind::Z: {
+				auto z = makeEventShared<ZBoson>(FourMomentum(91190, 0, 0, 0));
+				z->setDecayParticles(decay(*z, stream));
+				return summarise(kind, *z);
+			}
+			default: {
+				auto higgs = makeEventShared<HiggsBoson>(FourMomentum(125110, 0, 0, 0));
+				higgs->setDecayParticles(decay(*higgs, stream));
+				return summarise(kind, *higgs);
+			}
+		}
+	}
+
+	// Generate events [0, nEvents) across the thread pool. Summaries, if requested, are stored by event number.
+	GeneratorReport run(std::size_t nEvents, std::vector<EventSummary>* summaries = nullptr) const {
+		TRACE_SPAN_ARG("EventGenerator::run", "generator", nEvents);
+		if(summaries)
+			summaries->assign(nEvents, EventSummary{});
+		std::vector<ChunkTotals> chunks((nEvents + m_grain - 1) / m_grain);
+
+		const auto start = std::chrono::steady_clock::now();
+		{
+			WorkStealingPool pool(m_threads);
+			pool.parallelFor(0, nEvents, m_grain, [this, summaries, &chunks](std::size_t begin, std::size_t end) {
+				TRACE_SPAN_ARG("generate chunk", "generator", begin);
+				thread_local EventArena arena;
+				ChunkTotals& totals = chunks[begin / m_grain];
+				for(std::size_t id = begin; id < end; ++id) {
+					METRICS_TIME_SAMPLED(EventGenerationNs);
+					PhiloxEngine stream = RandomService::eventStream(id);
+					RandomService::ScopedRandomStream bindStream(stream);
+					EventSummary summary;
+					{
+						EventScope bindArena(arena);
+						summary = generateEvent(stream);
+					}
+					arena.reset();
+					totals.add(summary);
+					if(summaries)
+						(*summaries)[id] = summary;
+				}
+			});
+		}
+		const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+		GeneratorReport report;
+		report.events = nEvents;
+		report.threads = m_threads;
+		report.seconds = elapsed.count();
+		report.eventsPerSecond = report.seconds > 0.0 ? nEvents / report.seconds : 0.0;
+		report.checksum = HASH_SEED;
+		TRACE_SPAN("summarise events", "validation");
+		for(const auto& totals : chunks) {
+			for(std::size_t kind = 0; kind < totals.eventsOfKind.size(); ++kind)
+				report.eventsOfKind[kind] += totals.eventsOfKind[kind];
+			report.chargeViolations += totals.chargeViolations;
+			report.checksum = mix(report.checksum, totals.hash);
+		}
+		return report;
+	}
+};
+
+#endif // EVENT_GENERATOR_HPP
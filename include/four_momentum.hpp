@@ -1,16 +1,21 @@
 // Project-2 - Luca Vicaria - PHYS30762
 // This file defines the FourMomentum class used to manage energy and momentum of particles.
-// It includes methods to compute invariant mass and perform vector operations on four-momenta.
-// Last modified 08/05/2024
+// It includes methods to compute invariant mass, perform vector operations, and apply Lorentz boosts and rotations.
+// Last modified 16/10/2026
 
 #ifndef FOUR_MOMENTUM_HPP
 #define FOUR_MOMENTUM_HPP
 
+#include <array>
 #include <cmath>
+#include <limits>
+#include <memory>
 #include <stdexcept>
 #include <sstream>
 #include <iostream>
 
+#include "metrics.hpp"
+
 class FourMomentum {
 private:
 	double m_rest_mass;
@@ -21,10 +26,10 @@ private:
 
 public:
 	// Default constructor initializes to zero which is always valid
-	FourMomentum() : m_energy(0.0), m_px(0.0), m_py(0.0), m_pz(0.0) {}
+	FourMomentum() : m_rest_mass(0.0), m_energy(0.0), m_px(0.0), m_py(0.0), m_pz(0.0) {}
 
 	// Parameterized constructor with validation
-	FourMomentum(double e, double x, double y, double z) : m_energy(e), m_px(x), m_py(y), m_pz(z) {
+	FourMomentum(double e, double x, double y, double z) : m_rest_mass(0.0), m_energy(e), m_px(x), m_py(y), m_pz(z) {
 	}
 
 	// Copy and move constructors can rely on the validity of the source object
@@ -44,10 +49,19 @@ public:
 	double get_py() const { return m_py; }
 	double get_pz() const { return m_pz; }
 
+	// Tolerance on the difference between the invariant mass and the rest mass in every validity check
+	static constexpr double MASS_TOLERANCE = 1e-5;
+
+	// True if the energy is non-negative and the invariant mass is equal to the rest mass, within the tolerance.
+	// Unlike validate() this neither writes to std::cerr nor counts a failure, so it is cheap to call speculatively.
+	bool is_valid(double tolerance = MASS_TOLERANCE) const {
+		return m_energy >= 0 && std::abs(invariant_mass() - m_rest_mass) <= tolerance;
+	}
+
 	// Validates the four-momentum to ensure energy is greater than 0 and the invariant mass is equal to the rest mass of the particle that the four-momentum belongs to.
 	bool validate() {
-		const double tolerance = 1e-5;  // Define a suitable tolerance level for floating-point comparisons
-		if(this->m_energy < 0 || std::abs(this->invariant_mass() - m_rest_mass) > tolerance) {
+		if(!is_valid()) {
+			METRICS_INCREMENT(FourMomentumValidationFailures);
 			std::cerr<<"Physical inconsistency: Energy cannot be negative and the invariant mass must be equal to the rest mass of the particle."<< std::endl;
 			return false;
 		} else {
@@ -63,7 +77,8 @@ public:
 		m_rest_mass = rest_mass;
 	}
 
-	// Setters with validation
+	// Setters with validation. Each validates on its own, so moving a four-momentum between two on-shell points
+	// component by component fails part way through; use set_components() or update() to change several at once.
 	void set_energy(double e) {
 		m_energy = e;
 		if(validate())
@@ -96,6 +111,39 @@ public:
 			throw std::invalid_argument("Invalid four-momentum: Energy must be greater than or equal to the magnitude of the momentum vector and invariant mass must be non-negative.");
 	}
 
+	// Set all four components and validate once. If the result is invalid the four-momentum is left unchanged.
+	void set_components(double e, double x, double y, double z) {
+		FourMomentum updated(*this);
+		updated.m_energy = e;
+		updated.m_px = x;
+		updated.m_py = y;
+		updated.m_pz = z;
+		if(!updated.validate())
+			throw std::invalid_argument("Invalid four-momentum: Energy must be greater than or equal to the magnitude of the momentum vector and invariant mass must be non-negative.");
+		*this = updated;
+	}
+
+	// Stage changes to any of the components, validated once when committed, e.g. p.update().px(x).pz(z).commit()
+	class Update {
+	private:
+		FourMomentum& m_target;
+		double m_energy, m_px, m_py, m_pz;
+
+	public:
+		explicit Update(FourMomentum& target)
+			: m_target(target), m_energy(target.m_energy), m_px(target.m_px), m_py(target.m_py), m_pz(target.m_pz) {}
+
+		Update& energy(double e) { m_energy = e; return *this; }
+		Update& px(double x) { m_px = x; return *this; }
+		Update& py(double y) { m_py = y; return *this; }
+		Update& pz(double z) { m_pz = z; return *this; }
+
+		// Apply the staged components, throwing and leaving the target unchanged if they are invalid
+		void commit() { m_target.set_components(m_energy, m_px, m_py, m_pz); }
+	};
+
+	Update update() { return Update(*this); }
+
 	// Operator overload for addition and subtraction of four-momenta
 	FourMomentum operator+(const FourMomentum& other) const {
 		return FourMomentum(m_energy + other.m_energy, m_px + other.m_px, m_py + other.m_py, m_pz + other.m_pz);
@@ -115,6 +163,79 @@ public:
 		return std::sqrt(std::max(0.0, this->m_energy * this->m_energy - (this->m_px * this->m_px + this->m_py * this->m_py + this->m_pz * this->m_pz)));
 	}
 
+	// Magnitude of the three-momentum
+	double momentum() const {
+		return std::sqrt(m_px * m_px + m_py * m_py + m_pz * m_pz);
+	}
+
+	double transverse_momentum() const {
+		return std::sqrt(m_px * m_px + m_py * m_py);
+	}
+
+	// Azimuthal angle in (-pi, pi]
+	double phi() const {
+		return std::atan2(m_py, m_px);
+	}
+
+	// Rapidity y = 0.5 ln((E + pz) / (E - pz)), infinite along the beam axis
+	double rapidity() const {
+		return 0.5 * std::log((m_energy + m_pz) / (m_energy - m_pz));
+	}
+
+	// Pseudorapidity eta = asinh(pz / pt), infinite along the beam axis
+	double pseudorapidity() const {
+		double pt = transverse_momentum();
+		if(pt == 0.0)
+			return m_pz == 0.0 ? 0.0 : std::copysign(std::numeric_limits<double>::infinity(), m_pz);
+		return std::asinh(m_pz / pt);
+	}
+
+	// Velocity p/E of the frame in which this four-momentum is at rest
+	std::array<double, 3> boost_vector() const {
+		return {m_px / m_energy, m_py / m_energy, m_pz / m_energy};
+	}
+
+	// Lorentz boost by velocity (bx, by, bz), in units of c. The rest mass is unchanged by a boost.
+	FourMomentum boosted(double bx, double by, double bz) const {
+		const double beta2 = bx * bx + by * by + bz * bz;
+		if(beta2 >= 1.0)
+			throw std::invalid_argument("Boost velocity must be smaller than the speed of light.");
+		const double gamma = 1.0 / std::sqrt(1.0 - beta2);
+		const double bp = bx * m_px + by * m_py + bz * m_pz;
+		const double factor = gamma * gamma / (gamma + 1.0) * bp + gamma * m_energy; // (gamma - 1) / beta^2 == gamma^2 / (gamma + 1)
+		FourMomentum result(gamma * (m_energy + bp), m_px + factor * bx, m_py + factor * by, m_pz + factor * bz);
+		result.m_rest_mass = m_rest_mass;
+		return result;
+	}
+
+	// The same four-momentum seen from the rest frame of another (time-like) four-momentum
+	FourMomentum boosted_to_rest_frame_of(const FourMomentum& frame) const {
+		auto beta = frame.boost_vector();
+		return boosted(-beta[0], -beta[1], -beta[2]);
+	}
+
+	// Rotations of the three-momentum about the coordinate axes by angle radians
+	FourMomentum rotated_x(double angle) const {
+		const double c = std::cos(angle), s = std::sin(angle);
+		FourMomentum result(m_energy, m_px, c * m_py - s * m_pz, s * m_py + c * m_pz);
+		result.m_rest_mass = m_rest_mass;
+		return result;
+	}
+
+	FourMomentum rotated_y(double angle) const {
+		const double c = std::cos(angle), s = std::sin(angle);
+		FourMomentum result(m_energy, c * m_px + s * m_pz, m_py, c * m_pz - s * m_px);
+		result.m_rest_mass = m_rest_mass;
+		return result;
+	}
+
+	FourMomentum rotated_z(double angle) const {
+		const double c = std::cos(angle), s = std::sin(angle);
+		FourMomentum result(m_energy, c * m_px - s * m_py, s * m_px + c * m_py, m_pz);
+		result.m_rest_mass = m_rest_mass;
+		return result;
+	}
+
 	std::string print_four_momentum() const {
 		std::ostringstream out;
 		out<<"(E="<<m_energy<<", Px="<<m_px<<", Py="<<m_py<<", Pz="<<m_pz<<")";
@@ -122,4 +243,42 @@ public:
 	}
 };
 
+// Explicit request for particles to share one FourMomentum object instead of each holding its own copy.
+// Every sharer sees changes made through the others, including the rest mass set by each particle's constructor.
+class SharedFourMomentum {
+private:
+	std::shared_ptr<FourMomentum> m_pointer;
+
+public:
+	explicit SharedFourMomentum(std::shared_ptr<FourMomentum> pointer) : m_pointer(std::move(pointer)) {
+		if(!m_pointer)
+			throw std::invalid_argument("A shared four-momentum needs an object to share.");
+	}
+
+	const std::shared_ptr<FourMomentum>& pointer() const { return m_pointer; }
+};
+
+// The four-momentum owned by a particle: held by value, so constructing a particle needs no separate allocation
+// and reading it no reference count, unless the particle was given a SharedFourMomentum
+class ParticleMomentum {
+private:
+	FourMomentum m_value;
+	std::shared_ptr<FourMomentum> m_shared;
+
+public:
+	ParticleMomentum(const FourMomentum& value = FourMomentum()) : m_value(value) {}
+	ParticleMomentum(SharedFourMomentum shared) : m_shared(shared.pointer()) {}
+
+	bool isShared() const { return m_shared != nullptr; }
+	const FourMomentum& get() const { return m_shared ? *m_shared : m_value; }
+	FourMomentum& get() { return m_shared ? *m_shared : m_value; }
+
+	// Move the value into a shared object, if it is not one already, and return a handle to it
+	SharedFourMomentum share() {
+		if(!m_shared)
+			m_shared = std::make_shared<FourMomentum>(m_value);
+		return SharedFourMomentum(m_shared);
+	}
+};
+
 #endif // FOUR_MOMENTUM_HPP
@@ -0,0 +1,619 @@
+// Project-2 - Luca Vicaria - PHYS30762
+// This file defines the FourMomentumBatch class, a struct-of-arrays store for large numbers of four-momenta.
+// It provides SIMD kernels (AVX2, SSE2 or scalar) for invariant mass, dot product, transverse momentum, summation,
+// Lorentz boosts, rotations and on-shell validation,
+// and proxy types which let FourMomentum-style code view a single row without copying it.
+// Last modified 16/10/2026
+
+#ifndef FOUR_MOMENTUM_BATCH_HPP
+#define FOUR_MOMENTUM_BATCH_HPP
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#if defined(__AVX2__) || defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+#include "four_momentum.hpp"
+
+// Allocator returning memory aligned for the widest vector register used by the kernels
+template <typename T, std::size_t Alignment = 32>
+class AlignedAllocator {
+public:
+	using value_type = T;
+
+	template <typename U>
+	struct rebind { using other = AlignedAllocator<U, Alignment>; };
+
+	AlignedAllocator() noexcept = default;
+	template <typename U>
+	AlignedAllocator(const AlignedAllocator<U, Alignment>&) noexcept {}
+
+	T* allocate(std::size_t n) {
+		// std::aligned_alloc requires the size to be a multiple of the alignment
+		std::size_t bytes = ((n * sizeof(T) + Alignment - 1) / Alignment) * Alignment;
+		void* memory = std::aligned_alloc(Alignment, bytes == 0 ? Alignment : bytes);
+		if(!memory)
+			throw std::bad_alloc();
+		return static_cast<T*>(memory);
+	}
+
+	void deallocate(T* pointer, std::size_t) noexcept { std::free(pointer); }
+
+	template <typename U>
+	bool operator==(const AlignedAllocator<U, Alignment>&) const noexcept { return true; }
+	template <typename U>
+	bool operator!=(const AlignedAllocator<U, Alignment>&) const noexcept { return false; }
+};
+
+using AlignedDoubleVector = std::vector<double, AlignedAllocator<double>>;
+
+// Read-only view of one row of a FourMomentumBatch, exposing the same getters as FourMomentum
+class FourMomentumConstRef {
+protected:
+	const double* m_energy;
+	const double* m_px;
+	const double* m_py;
+	const double* m_pz;
+
+public:
+	FourMomentumConstRef(const double* e, const double* x, const double* y, const double* z)
+		: m_energy(e), m_px(x), m_py(y), m_pz(z) {}
+
+	double get_energy() const { return *m_energy; }
+	double get_px() const { return *m_px; }
+	double get_py() const { return *m_py; }
+	double get_pz() const { return *m_pz; }
+
+	double dot_product(const FourMomentum& other) const {
+		return get_energy() * other.get_energy() - (get_px() * other.get_px() + get_py() * other.get_py() + get_pz() * other.get_pz());
+	}
+
+	double dot_product(const FourMomentumConstRef& other) const {
+		return get_energy() * other.get_energy() - (get_px() * other.get_px() + get_py() * other.get_py() + get_pz() * other.get_pz());
+	}
+
+	double invariant_mass() const {
+		return std::sqrt(std::max(0.0, dot_product(*this)));
+	}
+
+	double transverse_momentum() const {
+		return std::sqrt(get_px() * get_px() + get_py() * get_py());
+	}
+
+	double phi() const { return to_four_momentum().phi(); }
+	double rapidity() const { return to_four_momentum().rapidity(); }
+	double pseudorapidity() const { return to_four_momentum().pseudorapidity(); }
+
+	// Materialise the row as a standalone FourMomentum
+	FourMomentum to_four_momentum() const {
+		return FourMomentum(get_energy(), get_px(), get_py(), get_pz());
+	}
+
+	operator FourMomentum() const { return to_four_momentum(); }
+
+	std::string print_four_momentum() const { return to_four_momentum().print_four_momentum(); }
+};
+
+// Mutable view of one row of a FourMomentumBatch. Setters write straight into the columns without validation,
+// since a batch row carries no rest mass to validate against.
+class FourMomentumRef : public FourMomentumConstRef {
+public:
+	FourMomentumRef(double* e, double* x, double* y, double* z)
+		: FourMomentumConstRef(e, x, y, z) {}
+
+	void set_energy(double e) { *const_cast<double*>(m_energy) = e; }
+	void set_px(double x) { *const_cast<double*>(m_px) = x; }
+	void set_py(double y) { *const_cast<double*>(m_py) = y; }
+	void set_pz(double z) { *const_cast<double*>(m_pz) = z; }
+
+	FourMomentumRef& operator=(const FourMomentum& other) {
+		set_energy(other.get_energy());
+		set_px(other.get_px());
+		set_py(other.get_py());
+		set_pz(other.get_pz());
+		return *this;
+	}
+};
+
+class FourMomentumBatch {
+private:
+	AlignedDoubleVector m_energy;
+	AlignedDoubleVector m_px;
+	AlignedDoubleVector m_py;
+	AlignedDoubleVector m_pz;
+
+	void checkSameSize(const FourMomentumBatch& other) const {
+		if(other.size() != size())
+			throw std::invalid_argument("FourMomentumBatch sizes do not match.");
+	}
+
+public:
+	FourMomentumBatch() = default;
+	explicit FourMomentumBatch(std::size_t n) : m_energy(n, 0.0), m_px(n, 0.0), m_py(n, 0.0), m_pz(n, 0.0) {}
+
+	std::size_t size() const { return m_energy.size(); }
+	bool empty() const { return m_energy.empty(); }
+
+	void reserve(std::size_t n) {
+		m_energy.reserve(n);
+		m_px.reserve(n);
+		m_py.reserve(n);
+		m_pz.reserve(n);
+	}
+
+	void resize(std::size_t n) {
+		m_energy.resize(n, 0.0);
+		m_px.resize(n, 0.0);
+		m_py.resize(n, 0.0);
+		m_pz.resize(n, 0.0);
+	}
+
+	void clear() {
+		m_energy.clear();
+		m_px.clear();
+		m_py.clear();
+		m_pz.clear();
+	}
+
+	void push_back(double e, double x, double y, double z) {
+		m_energy.push_back(e);
+		m_px.push_back(x);
+		m_py.push_back(y);
+		m_pz.push_back(z);
+	}
+
+	void push_back(const FourMomentum& fourMomentum) {
+		push_back(fourMomentum.get_energy(), fourMomentum.get_px(), fourMomentum.get_py(), fourMomentum.get_pz());
+	}
+
+	// Row access through proxies
+	FourMomentumRef operator[](std::size_t i) { return FourMomentumRef(&m_energy[i], &m_px[i], &m_py[i], &m_pz[i]); }
+	FourMomentumConstRef operator[](std::size_t i) const { return FourMomentumConstRef(&m_energy[i], &m_px[i], &m_py[i], &m_pz[i]); }
+
+	FourMomentumRef at(std::size_t i) {
+		if(i >= size())
+			throw std::out_of_range("FourMomentumBatch index out of range.");
+		return (*this)[i];
+	}
+
+	FourMomentumConstRef at(std::size_t i) const {
+		if(i >= size())
+			throw std::out_of_range("FourMomentumBatch index out of range.");
+		return (*this)[i];
+	}
+
+	// Raw column access for kernels operating on contiguous arrays
+	double* energy_data() { return m_energy.data(); }
+	double* px_data() { return m_px.data(); }
+	double* py_data() { return m_py.data(); }
+	double* pz_data() { return m_pz.data(); }
+	const double* energy_data() const { return m_energy.data(); }
+	const double* px_data() const { return m_px.data(); }
+	const double* py_data() const { return m_py.data(); }
+	const double* pz_data() const { return m_pz.data(); }
+
+	// Invariant mass of every row, written to out[0..size())
+	void invariant_masses(double* out) const {
+		const double* e = energy_data();
+		const double* x = px_data();
+		const double* y = py_data();
+		const double* z = pz_data();
+		const std::size_t n = size();
+		std::size_t i = 0;
+		// max_pd returns its second operand for NaN, so a NaN row gives 0 like std::max(0.0, m2) in the scalar tail
+#if defined(__AVX2__)
+		const __m256d zero = _mm256_setzero_pd();
+		for(; i + 4 <= n; i += 4) {
+			__m256d ve = _mm256_load_pd(e + i), vx = _mm256_load_pd(x + i), vy = _mm256_load_pd(y + i), vz = _mm256_load_pd(z + i);
+			__m256d p2 = _mm256_add_pd(_mm256_add_pd(_mm256_mul_pd(vx, vx), _mm256_mul_pd(vy, vy)), _mm256_mul_pd(vz, vz));
+			__m256d m2 = _mm256_max_pd(_mm256_sub_pd(_mm256_mul_pd(ve, ve), p2), zero);
+			_mm256_storeu_pd(out + i, _mm256_sqrt_pd(m2));
+		}
+#elif defined(__SSE2__)
+		const __m128d zero = _mm_setzero_pd();
+		for(; i + 2 <= n; i += 2) {
+			__m128d ve = _mm_load_pd(e + i), vx = _mm_load_pd(x + i), vy = _mm_load_pd(y + i), vz = _mm_load_pd(z + i);
+			__m128d p2 = _mm_add_pd(_mm_add_pd(_mm_mul_pd(vx, vx), _mm_mul_pd(vy, vy)), _mm_mul_pd(vz, vz));
+			__m128d m2 = _mm_max_pd(_mm_sub_pd(_mm_mul_pd(ve, ve), p2), zero);
+			_mm_storeu_pd(out + i, _mm_sqrt_pd(m2));
+		}
+#endif
+		for(; i < n; ++i)
+			out[i] = std::sqrt(std::max(0.0, e[i] * e[i] - (x[i] * x[i] + y[i] * y[i] + z[i] * z[i])));
+	}
+
+	// Transverse momentum sqrt(px^2 + py^2) of every row
+	void transverse_momenta(double* out) const {
+		const double* x = px_data();
+		const double* y = py_data();
+		const std::size_t n = size();
+		std::size_t i = 0;
+#if defined(__AVX2__)
+		for(; i + 4 <= n; i += 4) {
+			__m256d vx = _mm256_load_pd(x + i), vy = _mm256_load_pd(y + i);
+			_mm256_storeu_pd(out + i, _mm256_sqrt_pd(_mm256_add_pd(_mm256_mul_pd(vx, vx), _mm256_mul_pd(vy, vy))));
+		}
+#elif defined(__SSE2__)
+		for(; i + 2 <= n; i += 2) {
+			__m128d vx = _mm_load_pd(x + i), vy = _mm_load_pd(y + i);
+			_mm_storeu_pd(out + i, _mm_sqrt_pd(_mm_add_pd(_mm_mul_pd(vx, vx), _mm_mul_pd(vy, vy))));
+		}
+#endif
+		for(; i < n; ++i)
+			out[i] = std::sqrt(x[i] * x[i] + y[i] * y[i]);
+	}
+
+	// Minkowski dot product of each row with the matching row of another batch of the same size
+	void dot_products(const FourMomentumBatch& other, double* out) const {
+		checkSameSize(other);
+		const double* e = energy_data(); const double* oe = other.energy_data();
+		const double* x = px_data(); const double* ox = other.px_data();
+		const double* y = py_data(); const double* oy = other.py_data();
+		const double* z = pz_data(); const double* oz = other.pz_data();
+		const std::size_t n = size();
+		std::size_t i = 0;
+#if defined(__AVX2__)
+		for(; i + 4 <= n; i += 4) {
+			__m256d p = _mm256_add_pd(_mm256_add_pd(_mm256_mul_pd(_mm256_load_pd(x + i), _mm256_load_pd(ox + i)),
+			                                        _mm256_mul_pd(_mm256_load_pd(y + i), _mm256_load_pd(oy + i))),
+			                          _mm256_mul_pd(_mm256_load_pd(z + i), _mm256_load_pd(oz + i)));
+			_mm256_storeu_pd(out + i, _mm256_sub_pd(_mm256_mul_pd(_mm256_load_pd(e + i), _mm256_load_pd(oe + i)), p));
+		}
+#elif defined(__SSE2__)
+		for(; i + 2 <= n; i += 2) {
+			__m128d p = _mm_add_pd(_mm_add_pd(_mm_mul_pd(_mm_load_pd(x + i), _mm_load_pd(ox + i)),
+			                                  _mm_mul_pd(_mm_load_pd(y + i), _mm_load_pd(oy + i))),
+			                       _mm_mul_pd(_mm_load_pd(z + i), _mm_load_pd(oz + i)));
+			_mm_storeu_pd(out + i, _mm_sub_pd(_mm_mul_pd(_mm_load_pd(e + i), _mm_load_pd(oe + i)), p));
+		}
+#endif
+		for(; i < n; ++i)
+			out[i] = e[i] * oe[i] - (x[i] * ox[i] + y[i] * oy[i] + z[i] * oz[i]);
+	}
+
+	// Sum of the rows in [begin, end), the batched equivalent of repeated FourMomentum::operator+
+	FourMomentum sum(std::size_t begin, std::size_t end) const {
+		if(begin > end || end > size())
+			throw std::out_of_range("FourMomentumBatch sum range out of bounds.");
+		const double* e = energy_data();
+		const double* x = px_data();
+		const double* y = py_data();
+		const double* z = pz_data();
+		double se = 0.0, sx = 0.0, sy = 0.0, sz = 0.0;
+		std::size_t i = begin;
+#if defined(__AVX2__)
+		__m256d ae = _mm256_setzero_pd(), ax = _mm256_setzero_pd(), ay = _mm256_setzero_pd(), az = _mm256_setzero_pd();
+		for(; i + 4 <= end; i += 4) {
+			ae = _mm256_add_pd(ae, _mm256_loadu_pd(e + i));
+			ax = _mm256_add_pd(ax, _mm256_loadu_pd(x + i));
+			ay = _mm256_add_pd(ay, _mm256_loadu_pd(y + i));
+			az = _mm256_add_pd(az, _mm256_loadu_pd(z + i));
+		}
+		alignas(32) double lanes[4];
+		_mm256_store_pd(lanes, ae); se = (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+		_mm256_store_pd(lanes, ax); sx = (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+		_mm256_store_pd(lanes, ay); sy = (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+		_mm256_store_pd(lanes, az); sz = (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+#elif defined(__SSE2__)
+		__m128d ae = _mm_setzero_pd(), ax = _mm_setzero_pd(), ay = _mm_setzero_pd(), az = _mm_setzero_pd();
+		for(; i + 2 <= end; i += 2) {
+			ae = _mm_add_pd(ae, _mm_loadu_pd(e + i));
+			ax = _mm_add_pd(ax, _mm_loadu_pd(x + i));
+			ay = _mm_add_pd(ay, _mm_loadu_pd(y + i));
+			az = _mm_add_pd(az, _mm_loadu_pd(z + i));
+		}
+		alignas(16) double lanes[2];
+		_mm_store_pd(lanes, ae); se = lanes[0] + lanes[1];
+		_mm_store_pd(lanes, ax); sx = lanes[0] + lanes[1];
+		_mm_store_pd(lanes, ay); sy = lanes[0] + lanes[1];
+		_mm_store_pd(lanes, az); sz = lanes[0] + lanes[1];
+#endif
+		for(; i < end; ++i) {
+			se += e[i];
+			sx += x[i];
+			sy += y[i];
+			sz += z[i];
+		}
+		return FourMomentum(se, sx, sy, sz);
+	}
+
+	FourMomentum sum() const { return sum(0, size()); }
+
+private:
+	// Sources of the boost velocity for row i, read by boost_kernel one register of rows at a time
+	struct RowVelocity {
+		const double* bx;
+		const double* by;
+		const double* bz;
+
+#if defined(__AVX2__)
+		void load(std::size_t i, __m256d& vx, __m256d& vy, __m256d& vz) const {
+			vx = _mm256_loadu_pd(bx + i);
+			vy = _mm256_loadu_pd(by + i);
+			vz = _mm256_loadu_pd(bz + i);
+		}
+#elif defined(__SSE2__)
+		void load(std::size_t i, __m128d& vx, __m128d& vy, __m128d& vz) const {
+			vx = _mm_loadu_pd(bx + i);
+			vy = _mm_loadu_pd(by + i);
+			vz = _mm_loadu_pd(bz + i);
+		}
+#endif
+		void load(std::size_t i, double& vx, double& vy, double& vz) const {
+			vx = bx[i];
+			vy = by[i];
+			vz = bz[i];
+		}
+	};
+
+	// One velocity for every row, broadcast into registers once
+	struct ConstantVelocity {
+		double bx, by, bz;
+#if defined(__AVX2__)
+		__m256d wx, wy, wz;
+		ConstantVelocity(double x, double y, double z) : bx(x), by(y), bz(z), wx(_mm256_set1_pd(x)), wy(_mm256_set1_pd(y)), wz(_mm256_set1_pd(z)) {}
+
+		void load(std::size_t, __m256d& vx, __m256d& vy, __m256d& vz) const {
+			vx = wx;
+			vy = wy;
+			vz = wz;
+		}
+#elif defined(__SSE2__)
+		__m128d wx, wy, wz;
+		ConstantVelocity(double x, double y, double z) : bx(x), by(y), bz(z), wx(_mm_set1_pd(x)), wy(_mm_set1_pd(y)), wz(_mm_set1_pd(z)) {}
+
+		void load(std::size_t, __m128d& vx, __m128d& vy, __m128d& vz) const {
+			vx = wx;
+			vy = wy;
+			vz = wz;
+		}
+#else
+		ConstantVelocity(double x, double y, double z) : bx(x), by(y), bz(z) {}
+#endif
+		void load(std::size_t, double& vx, double& vy, double& vz) const {
+			vx = bx;
+			vy = by;
+			vz = bz;
+		}
+	};
+
+	// Velocity -p/E taking row i into the rest frame of row i of another batch, computed as the rows are boosted
+	struct RestFrameVelocity {
+		const double* e;
+		const double* x;
+		const double* y;
+		const double* z;
+
+#if defined(__AVX2__)
+		void load(std::size_t i, __m256d& vx, __m256d& vy, __m256d& vz) const {
+			const __m256d minusInverse = _mm256_div_pd(_mm256_set1_pd(-1.0), _mm256_load_pd(e + i));
+			vx = _mm256_mul_pd(_mm256_load_pd(x + i), minusInverse);
+			vy = _mm256_mul_pd(_mm256_load_pd(y + i), minusInverse);
+			vz = _mm256_mul_pd(_mm256_load_pd(z + i), minusInverse);
+		}
+#elif defined(__SSE2__)
+		void load(std::size_t i, __m128d& vx, __m128d& vy, __m128d& vz) const {
+			const __m128d minusInverse = _mm_div_pd(_mm_set1_pd(-1.0), _mm_load_pd(e + i));
+			vx = _mm_mul_pd(_mm_load_pd(x + i), minusInverse);
+			vy = _mm_mul_pd(_mm_load_pd(y + i), minusInverse);
+			vz = _mm_mul_pd(_mm_load_pd(z + i), minusInverse);
+		}
+#endif
+		void load(std::size_t i, double& vx, double& vy, double& vz) const {
+			const double minusInverse = -1.0 / e[i];
+			vx = x[i] * minusInverse;
+			vy = y[i] * minusInverse;
+			vz = z[i] * minusInverse;
+		}
+	};
+
+	// Boost rows [0, n) of the given columns, row i by the velocity the source gives for it
+	template <typename Velocity>
+	static void boost_kernel(std::size_t n, double* e, double* x, double* y, double* z, const Velocity& velocity) {
+		std::size_t i = 0;
+#if defined(__AVX2__)
+		const __m256d one = _mm256_set1_pd(1.0);
+		for(; i + 4 <= n; i += 4) {
+			__m256d vbx, vby, vbz;
+			velocity.load(i, vbx, vby, vbz);
+			__m256d ve = _mm256_loadu_pd(e + i), vx = _mm256_loadu_pd(x + i), vy = _mm256_loadu_pd(y + i), vz = _mm256_loadu_pd(z + i);
+			__m256d beta2 = _mm256_add_pd(_mm256_add_pd(_mm256_mul_pd(vbx, vbx), _mm256_mul_pd(vby, vby)), _mm256_mul_pd(vbz, vbz));
+			__m256d gamma = _mm256_div_pd(one, _mm256_sqrt_pd(_mm256_sub_pd(one, beta2)));
+			__m256d bp = _mm256_add_pd(_mm256_add_pd(_mm256_mul_pd(vbx, vx), _mm256_mul_pd(vby, vy)), _mm256_mul_pd(vbz, vz));
+			__m256d g2 = _mm256_div_pd(_mm256_mul_pd(gamma, gamma), _mm256_add_pd(gamma, one));
+			__m256d factor = _mm256_add_pd(_mm256_mul_pd(g2, bp), _mm256_mul_pd(gamma, ve));
+			_mm256_storeu_pd(e + i, _mm256_mul_pd(gamma, _mm256_add_pd(ve, bp)));
+			_mm256_storeu_pd(x + i, _mm256_add_pd(vx, _mm256_mul_pd(factor, vbx)));
+			_mm256_storeu_pd(y + i, _mm256_add_pd(vy, _mm256_mul_pd(factor, vby)));
+			_mm256_storeu_pd(z + i, _mm256_add_pd(vz, _mm256_mul_pd(factor, vbz)));
+		}
+#elif defined(__SSE2__)
+		const __m128d one = _mm_set1_pd(1.0);
+		for(; i + 2 <= n; i += 2) {
+			__m128d vbx, vby, vbz;
+			velocity.load(i, vbx, vby, vbz);
+			__m128d ve = _mm_loadu_pd(e + i), vx = _mm_loadu_pd(x + i), vy = _mm_loadu_pd(y + i), vz = _mm_loadu_pd(z + i);
+			__m128d beta2 = _mm_add_pd(_mm_add_pd(_mm_mul_pd(vbx, vbx), _mm_mul_pd(vby, vby)), _mm_mul_pd(vbz, vbz));
+			__m128d gamma = _mm_div_pd(one, _mm_sqrt_pd(_mm_sub_pd(one, beta2)));
+			__m128d bp = _mm_add_pd(_mm_add_pd(_mm_mul_pd(vbx, vx), _mm_mul_pd(vby, vy)), _mm_mul_pd(vbz, vz));
+			__m128d g2 = _mm_div_pd(_mm_mul_pd(gamma, gamma), _mm_add_pd(gamma, one));
+			__m128d factor = _mm_add_pd(_mm_mul_pd(g2, bp), _mm_mul_pd(gamma, ve));
+			_mm_storeu_pd(e + i, _mm_mul_pd(gamma, _mm_add_pd(ve, bp)));
+			_mm_storeu_pd(x + i, _mm_add_pd(vx, _mm_mul_pd(factor, vbx)));
+			_mm_storeu_pd(y + i, _mm_add_pd(vy, _mm_mul_pd(factor, vby)));
+			_mm_storeu_pd(z + i, _mm_add_pd(vz, _mm_mul_pd(factor, vbz)));
+		}
+#endif
+		for(; i < n; ++i) {
+			double bx, by, bz;
+			velocity.load(i, bx, by, bz);
+			double beta2 = bx * bx + by * by + bz * bz;
+			double gamma = 1.0 / std::sqrt(1.0 - beta2);
+			double bp = bx * x[i] + by * y[i] + bz * z[i];
+			double factor = gamma * gamma / (gamma + 1.0) * bp + gamma * e[i];
+			e[i] = gamma * (e[i] + bp);
+			x[i] += factor * bx;
+			y[i] += factor * by;
+			z[i] += factor * bz;
+		}
+	}
+
+public:
+	// Boost rows [0, n) of the given columns, row i by velocity (bx[i], by[i], bz[i]). Shared with the phase-space generator.
+	static void boost_columns(std::size_t n, double* e, double* x, double* y, double* z, const double* bx, const double* by, const double* bz) {
+		boost_kernel(n, e, x, y, z, RowVelocity{bx, by, bz});
+	}
+
+	// Boost rows [0, n) of the given columns, all by the velocity (bx, by, bz)
+	static void boost_columns(std::size_t n, double* e, double* x, double* y, double* z, double bx, double by, double bz) {
+		boost_kernel(n, e, x, y, z, ConstantVelocity(bx, by, bz));
+	}
+
+	// Rotate the pairs (a[i], b[i]) by the angle with the given cosine and sine
+	static void rotate_columns(std::size_t n, double* a, double* b, double c, double s) {
+		std::size_t i = 0;
+#if defined(__AVX2__)
+		const __m256d vc = _mm256_set1_pd(c), vs = _mm256_set1_pd(s);
+		for(; i + 4 <= n; i += 4) {
+			__m256d va = _mm256_loadu_pd(a + i), vb = _mm256_loadu_pd(b + i);
+			_mm256_storeu_pd(a + i, _mm256_sub_pd(_mm256_mul_pd(vc, va), _mm256_mul_pd(vs, vb)));
+			_mm256_storeu_pd(b + i, _mm256_add_pd(_mm256_mul_pd(vs, va), _mm256_mul_pd(vc, vb)));
+		}
+#elif defined(__SSE2__)
+		const __m128d vc = _mm_set1_pd(c), vs = _mm_set1_pd(s);
+		for(; i + 2 <= n; i += 2) {
+			__m128d va = _mm_loadu_pd(a + i), vb = _mm_loadu_pd(b + i);
+			_mm_storeu_pd(a + i, _mm_sub_pd(_mm_mul_pd(vc, va), _mm_mul_pd(vs, vb)));
+			_mm_storeu_pd(b + i, _mm_add_pd(_mm_mul_pd(vs, va), _mm_mul_pd(vc, vb)));
+		}
+#endif
+		for(; i < n; ++i) {
+			double ai = a[i];
+			a[i] = c * ai - s * b[i];
+			b[i] = s * ai + c * b[i];
+		}
+	}
+
+	// Boost every row by the same velocity (bx, by, bz)
+	void boost(double bx, double by, double bz) {
+		if(bx * bx + by * by + bz * bz >= 1.0)
+			throw std::invalid_argument("Boost velocity must be smaller than the speed of light.");
+		boost_columns(size(), energy_data(), px_data(), py_data(), pz_data(), bx, by, bz);
+	}
+
+	// Boost row i by velocity (bx[i], by[i], bz[i])
+	void boost(const double* bx, const double* by, const double* bz) {
+		boost_columns(size(), energy_data(), px_data(), py_data(), pz_data(), bx, by, bz);
+	}
+
+	// Boost row i into the rest frame of row i of frames
+	void boost_to_rest_frames(const FourMomentumBatch& frames) {
+		checkSameSize(frames);
+		boost_kernel(size(), energy_data(), px_data(), py_data(), pz_data(), RestFrameVelocity{frames.energy_data(), frames.px_data(), frames.py_data(), frames.pz_data()});
+	}
+
+	// Rotate every row's three-momentum about a coordinate axis
+	void rotate_x(double angle) { rotate_columns(size(), py_data(), pz_data(), std::cos(angle), std::sin(angle)); }
+	void rotate_y(double angle) { rotate_columns(size(), pz_data(), px_data(), std::cos(angle), std::sin(angle)); }
+	void rotate_z(double angle) { rotate_columns(size(), px_data(), py_data(), std::cos(angle), std::sin(angle)); }
+
+	// Angular variables of every row. These rely on libm transcendentals and are left to the compiler to vectorise.
+	void phis(double* out) const {
+		for(std::size_t i = 0; i < size(); ++i)
+			out[i] = std::atan2(m_py[i], m_px[i]);
+	}
+
+	void rapidities(double* out) const {
+		for(std::size_t i = 0; i < size(); ++i)
+			out[i] = 0.5 * std::log((m_energy[i] + m_pz[i]) / (m_energy[i] - m_pz[i]));
+	}
+
+	void pseudorapidities(double* out) const {
+		for(std::size_t i = 0; i < size(); ++i)
+			out[i] = (*this)[i].pseudorapidity();
+	}
+
+	// Append to out the index of every row that FourMomentum::is_valid would reject given restMasses[row]: negative
+	// energy, or an invariant mass differing from the rest mass by more than the tolerance. Nothing is printed or
+	// thrown, so a whole file of four-momenta can be checked in one pass and only the failures handled.
+	void find_off_shell(const double* restMasses, std::vector<std::size_t>& out, double tolerance = FourMomentum::MASS_TOLERANCE) const {
+		const double* e = energy_data();
+		const double* x = px_data();
+		const double* y = py_data();
+		const double* z = pz_data();
+		const std::size_t n = size();
+		std::size_t i = 0;
+#if defined(__AVX2__)
+		// max_pd returns its second operand for NaN, matching std::max(0.0, m2) in the scalar invariant mass
+		const __m256d zero = _mm256_setzero_pd();
+		const __m256d signBit = _mm256_set1_pd(-0.0);
+		const __m256d limit = _mm256_set1_pd(tolerance);
+		for(; i + 4 <= n; i += 4) {
+			__m256d ve = _mm256_load_pd(e + i), vx = _mm256_load_pd(x + i), vy = _mm256_load_pd(y + i), vz = _mm256_load_pd(z + i);
+			__m256d p2 = _mm256_add_pd(_mm256_add_pd(_mm256_mul_pd(vx, vx), _mm256_mul_pd(vy, vy)), _mm256_mul_pd(vz, vz));
+			__m256d mass = _mm256_sqrt_pd(_mm256_max_pd(_mm256_sub_pd(_mm256_mul_pd(ve, ve), p2), zero));
+			__m256d deviation = _mm256_andnot_pd(signBit, _mm256_sub_pd(mass, _mm256_loadu_pd(restMasses + i)));
+			__m256d valid = _mm256_and_pd(_mm256_cmp_pd(ve, zero, _CMP_GE_OQ), _mm256_cmp_pd(deviation, limit, _CMP_LE_OQ));
+			const int validLanes = _mm256_movemask_pd(valid);
+			if(validLanes != 0xF) {
+				for(std::size_t lane = 0; lane < 4; ++lane) {
+					if(!(validLanes >> lane & 1))
+						out.push_back(i + lane);
+				}
+			}
+		}
+#elif defined(__SSE2__)
+		const __m128d zero = _mm_setzero_pd();
+		const __m128d signBit = _mm_set1_pd(-0.0);
+		const __m128d limit = _mm_set1_pd(tolerance);
+		for(; i + 2 <= n; i += 2) {
+			__m128d ve = _mm_load_pd(e + i), vx = _mm_load_pd(x + i), vy = _mm_load_pd(y + i), vz = _mm_load_pd(z + i);
+			__m128d p2 = _mm_add_pd(_mm_add_pd(_mm_mul_pd(vx, vx), _mm_mul_pd(vy, vy)), _mm_mul_pd(vz, vz));
+			__m128d mass = _mm_sqrt_pd(_mm_max_pd(_mm_sub_pd(_mm_mul_pd(ve, ve), p2), zero));
+			__m128d deviation = _mm_andnot_pd(signBit, _mm_sub_pd(mass, _mm_loadu_pd(restMasses + i)));
+			__m128d valid = _mm_and_pd(_mm_cmpge_pd(ve, zero), _mm_cmple_pd(deviation, limit));
+			const int validLanes = _mm_movemask_pd(valid);
+			if(validLanes != 0x3) {
+				for(std::size_t lane = 0; lane < 2; ++lane) {
+					if(!(validLanes >> lane & 1))
+						out.push_back(i + lane);
+				}
+			}
+		}
+#endif
+		for(; i < n; ++i) {
+			const double mass = std::sqrt(std::max(0.0, e[i] * e[i] - (x[i] * x[i] + y[i] * y[i] + z[i] * z[i])));
+			if(!(e[i] >= 0 && std::abs(mass - restMasses[i]) <= tolerance))
+				out.push_back(i);
+		}
+	}
+
+	// Convenience wrappers returning freshly allocated results
+	std::vector<double> invariant_masses() const {
+		std::vector<double> out(size());
+		invariant_masses(out.data());
+		return out;
+	}
+
+	std::vector<double> transverse_momenta() const {
+		std::vector<double> out(size());
+		transverse_momenta(out.data());
+		return out;
+	}
+
+	std::vector<std::size_t> find_off_shell(const double* restMasses, double tolerance = FourMomentum::MASS_TOLERANCE) const {
+		std::vector<std::size_t> out;
+		find_off_shell(restMasses, out, tolerance);
+		return out;
+	}
+};
+
+#endif // FOUR_MOMENTUM_BATCH_HPP
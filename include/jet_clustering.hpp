@@ -0,0 +1,463 @@
+// Project-2 - Luca Vicaria - PHYS30762
+// This file defines sequential-recombination jet clustering with the anti-kT, kT and Cambridge/Aachen algorithms.
+// Distances follow the generalised kT family with E-scheme recombination:
+//     d_ij = min(kt_i^2p, kt_j^2p) dR_ij^2 / R^2,  d_iB = kt_i^2p,  p = -1 (anti-kT), 1 (kT), 0 (Cambridge/Aachen).
+// The smallest d_ij always pairs a jet with its geometric nearest neighbour, so each jet only tracks its nearest
+// neighbour. Jets are binned into rapidity-phi tiles at least R wide, so neighbours are found in the 3x3 block of
+// tiles around a jet, and the smallest distance is taken from a min-heap whose stale entries are skipped when
+// popped. After each recombination only the jets in the tiles around the merged pair are updated.
+// Last modified 16/10/2026
+
+#ifndef JET_CLUSTERING_HPP
+#define JET_CLUSTERING_HPP
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <initializer_list>
+#include <memory>
+#include <stdexcept>
+#include <vector>
+
+#include "particle.hpp"
+#include "four_momentum.hpp"
+#include "four_momentum_batch.hpp"
+#include "thread_pool.hpp"
+#include "trace.hpp"
+
+enum class JetAlgorithm { AntiKt, Kt, CambridgeAachen };
+
+struct JetDefinition {
+	JetAlgorithm algorithm = JetAlgorithm::AntiKt;
+	double radius = 0.4;
+	double ptMin = 0.0; // Jets below this transverse momentum (MeV) are discarded
+
+	void validate() const {
+		// At least three phi tiles are needed for the 3x3 neighbourhood to be distinct tiles
+		if(!(radius > 0.0 && radius <= 2.0 * 3.141592653589793 / 3.0))
+			throw std::invalid_argument("Jet radius must be in (0, 2 pi / 3].");
+		if(!(ptMin >= 0.0))
+			throw std::invalid_argument("Minimum jet transverse momentum must be non-negative.");
+	}
+};
+
+// Jets of many events. Jets are ordered by decreasing transverse momentum within each event.
+struct JetCollection {
+	FourMomentumBatch jets;
+	std::vector<std::uint32_t> offsets{0}; // Event e's jets are rows [offsets[e], offsets[e + 1])
+	std::vector<std::int32_t> jetOf;       // For each input row, the index of its jet within its event, or -1
+
+	std::size_t events() const { return offsets.size() - 1; }
+	std::size_t jetCount(std::size_t event) const { return offsets[event + 1] - offsets[event]; }
+};
+
+class JetClusterer {
+private:
+	static constexpr double PI = 3.141592653589793;
+	static constexpr double TWO_PI = 2.0 * PI;
+	// Bounds the tiling for events spread far along the beam axis; the rapidity tiles then widen beyond R
+	static constexpr std::size_t MAX_RAPIDITY_TILES = 256;
+
+	struct HeapEntry {
+		double distance;
+		std::int32_t jet;
+		std::uint32_t version; // Stale unless equal to the jet's current version
+		bool operator>(const HeapEntry& other) const { return distance > other.distance; }
+	};
+
+	// Working state of one event, indexed by jet slot. Input particles take slots 0..n-1, and a recombined jet
+	// keeps the slot of the first of its pair.
+	struct Scratch {
+		std::vector<double> e, px, py, pz;
+		std::vector<double> y, phi, momentumFactor, nnDistance;
+		std::vector<std::int32_t> nn, tile, previous, next, parent;
+		std::vector<std::uint32_t> version;
+		std::vector<std::uint8_t> alive;
+		std::vector<std::int32_t> jetIndex;  // Output index of a slot that became a jet, -1 if discarded
+		std::vector<std::uint32_t> inputRow; // Event-local input row of each initial slot
+		std::vector<std::int32_t> tileHead;
+		std::vector<std::int32_t> tileNeighbours; // 3x3 block around each tile, 9 entries per tile padded with -1
+		std::vector<std::uint32_t> tileStamp;
+		std::vector<std::int32_t> candidates;
+		std::vector<std::int32_t> finished; // Slots that became jets, in order of completion
+		std::vector<HeapEntry> heap;
+		std::uint32_t stamp = 0;
+		std::size_t rapidityTiles = 0, phiTiles = 0;
+		double rapidityMin = 0.0, rapidityTileWidth = 0.0, phiTileWidth = 0.0;
+	};
+
+	JetDefinition m_definition;
+	double m_radius2;
+	Scratch m_scratch; // For the serial path
+
+	double momentumFactor(double kt2) const {
+		switch(m_definition.algorithm) {
+			case JetAlgorithm::AntiKt: return 1.0 / kt2;
+			case JetAlgorithm::Kt: return kt2;
+			default: return 1.0;
+		}
+	}
+
+	// Rapidity, or pseudorapidity for (numerically) lightlike momenta along which the rapidity is undefined
+	static double rapidity(double e, double pz, double pt) {
+		if(e - std::abs(pz) > 0.0)
+			return 0.5 * std::log((e + pz) / (e - pz));
+		return std::asinh(pz / pt);
+	}
+
+	static double distance2(const Scratch& s, std::int32_t a, std::int32_t b) {
+		const double dy = s.y[a] - s.y[b];
+		double dphi = std::abs(s.phi[a] - s.phi[b]);
+		dphi = dphi > PI ? TWO_PI - dphi : dphi;
+		return dy * dy + dphi * dphi;
+	}
+
+	// Fill the kinematic columns of a slot from its momentum
+	void setKinematics(Scratch& s, std::int32_t slot) const {
+		const double kt2 = s.px[slot] * s.px[slot] + s.py[slot] * s.py[slot];
+		s.y[slot] = rapidity(s.e[slot], s.pz[slot], std::sqrt(kt2));
+		double phi = std::atan2(s.py[slot], s.px[slot]);
+		s.phi[slot] = phi < 0.0 ? phi + TWO_PI : phi;
+		s.momentumFactor[slot] = momentumFactor(kt2);
+	}
+
+	static std::int32_t tileOf(const Scratch& s, double y, double phi) {
+		const double offset = (y - s.rapidityMin) / s.rapidityTileWidth;
+		const std::size_t yTile = offset <= 0.0 ? 0 : std::min(static_cast<std::size_t>(offset), s.rapidityTiles - 1);
+		const std::size_t phiTile = std::min(static_cast<std::size_t>(phi / s.phiTileWidth), s.phiTiles - 1);
+		return static_cast<std::int32_t>(yTile * s.phiTiles + phiTile);
+	}
+
+	// Lay out the tiles and list the 3x3 block of tiles around each one
+	static void buildTiles(Scratch& s) {
+		const std::size_t tiles = s.rapidityTiles * s.phiTiles;
+		s.tileHead.assign(tiles, -1);
+		s.tileStamp.assign(tiles, 0);
+		s.stamp = 0;
+		s.tileNeighbours.assign(9 * tiles, -1);
+		for(std::size_t yTile = 0; yTile < s.rapidityTiles; ++yTile) {
+			for(std::size_t phiTile = 0; phiTile < s.phiTiles; ++phiTile) {
+				std::int32_t* neighbours = &s.tileNeighbours[9 * (yTile * s.phiTiles + phiTile)];
+				const std::size_t yFirst = yTile > 0 ? yTile - 1 : 0, yLast = std::min(yTile + 1, s.rapidityTiles - 1);
+				for(std::size_t yt = yFirst; yt <= yLast; ++yt) {
+					for(std::size_t offset = s.phiTiles - 1; offset <= s.phiTiles + 1; ++offset)
+						*neighbours++ = static_cast<std::int32_t>(yt * s.phiTiles + (phiTile + offset) % s.phiTiles);
+				}
+			}
+		}
+	}
+
+	// Call visit(tile) for each tile in the 3x3 block around tile
+	template <typename Visit>
+	static void forNeighbourTiles(const Scratch& s, std::int32_t tile, Visit&& visit) {
+		const std::int32_t* neighbours = &s.tileNeighbours[9 * static_cast<std::size_t>(tile)];
+		for(int k = 0; k < 9 && neighbours[k] >= 0; ++k)
+			visit(neighbours[k]);
+	}
+
+	static void insert(Scratch& s, std::int32_t slot, std::int32_t tile) {
+		s.tile[slot] = tile;
+		s.previous[slot] = -1;
+		s.next[slot] = s.tileHead[tile];
+		if(s.tileHead[tile] >= 0)
+			s.previous[s.tileHead[tile]] = slot;
+		s.tileHead[tile] = slot;
+	}
+
+	static void remove(Scratch& s, std::int32_t slot) {
+		if(s.previous[slot] >= 0)
+			s.next[s.previous[slot]] = s.next[slot];
+		else
+			s.tileHead[s.tile[slot]] = s.next[slot];
+		if(s.next[slot] >= 0)
+			s.previous[s.next[slot]] = s.previous[slot];
+	}
+
+	// Nearest neighbour within R, searching the tiles around the slot
+	void findNearestNeighbour(Scratch& s, std::int32_t slot) const {
+		double best = m_radius2;
+		std::int32_t nearest = -1;
+		forNeighbourTiles(s, s.tile[slot], [&](std::int32_t tile) {
+			for(std::int32_t other = s.tileHead[tile]; other >= 0; other = s.next[other]) {
+				if(other != slot) {
+					const double d = distance2(s, slot, other);
+					if(d < best) {
+						best = d;
+						nearest = other;
+					}
+				}
+			}
+		});
+		s.nn[slot] = nearest;
+		s.nnDistance[slot] = best;
+	}
+
+	// Queue the slot's current smallest distance: to its nearest neighbour, or to the beam (scaled by R^2)
+	static void push(Scratch& s, std::int32_t slot) {
+		const std::int32_t nearest = s.nn[slot];
+		const double factor = nearest >= 0 ? std::min(s.momentumFactor[slot], s.momentumFactor[nearest]) : s.momentumFactor[slot];
+		s.heap.push_back(HeapEntry{factor * s.nnDistance[slot], slot, ++s.version[slot]});
+		std::push_heap(s.heap.begin(), s.heap.end(), std::greater<HeapEntry>());
+	}
+
+	// Gather the live jets of the tiles around each given tile, visiting each tile once
+	static void gatherCandidates(Scratch& s, std::initializer_list<std::int32_t> centres) {
+		s.candidates.clear();
+		++s.stamp;
+		for(std::int32_t centre : centres) {
+			forNeighbourTiles(s, centre, [&](std::int32_t tile) {
+				if(s.tileStamp[tile] == s.stamp)
+					return;
+				s.tileStamp[tile] = s.stamp;
+				for(std::int32_t other = s.tileHead[tile]; other >= 0; other = s.next[other])
+					s.candidates.push_back(other);
+			});
+		}
+	}
+
+	// Cluster the rows [first, last) of particles. Jets are appended to jets in decreasing transverse momentum, and
+	// jetOf, if given, receives the jet index of each row relative to the first appended jet.
+	void clusterEvent(Scratch& s, const FourMomentumBatch& particles, std::size_t first, std::size_t last,
+	                  FourMomentumBatch& jets, std::int32_t* jetOf) const {
+		const double* pe = particles.energy_data();
+		const double* ppx = particles.px_data();
+		const double* ppy = particles.py_data();
+		const double* ppz = particles.pz_data();
+
+		// Particles along the beam axis have no direction in rapidity-phi and are left out
+		s.inputRow.clear();
+		for(std::size_t row = first; row < last; ++row) {
+			if(ppx[row] != 0.0 || ppy[row] != 0.0)
+				s.inputRow.push_back(static_cast<std::uint32_t>(row - first));
+		}
+		const std::size_t n = s.inputRow.size();
+		for(auto* column : {&s.e, &s.px, &s.py, &s.pz, &s.y, &s.phi, &s.momentumFactor, &s.nnDistance})
+			column->resize(n);
+		for(auto* column : {&s.nn, &s.tile, &s.previous, &s.next, &s.parent, &s.jetIndex})
+			column->resize(n);
+		s.version.assign(n, 0);
+		s.alive.assign(n, 1);
+		s.heap.clear();
+
+		for(std::size_t slot = 0; slot < n; ++slot) {
+			const std::size_t row = first + s.inputRow[slot];
+			s.e[slot] = pe[row];
+			s.px[slot] = ppx[row];
+			s.py[slot] = ppy[row];
+			s.pz[slot] = ppz[row];
+			s.parent[slot] = static_cast<std::int32_t>(slot);
+			s.jetIndex[slot] = -1;
+			setKinematics(s, static_cast<std::int32_t>(slot));
+		}
+
+		// Tiles at least R wide, spanning the rapidity range of the inputs
+		const double radius = m_definition.radius;
+		double yMin = 0.0, yMax = 0.0;
+		if(n > 0) {
+			const auto range = std::minmax_element(s.y.begin(), s.y.end());
+			yMin = *range.first;
+			yMax = *range.second;
+		}
+		s.rapidityMin = yMin;
+		s.rapidityTileWidth = std::max(radius, (yMax - yMin) / (MAX_RAPIDITY_TILES - 1));
+		s.rapidityTiles = static_cast<std::size_t>((yMax - yMin) / s.rapidityTileWidth) + 1;
+		s.phiTiles = static_cast<std::size_t>(TWO_PI / radius);
+		s.phiTileWidth = TWO_PI / s.phiTiles;
+		buildTiles(s);
+
+		for(std::size_t slot = 0; slot < n; ++slot)
+			insert(s, static_cast<std::int32_t>(slot), tileOf(s, s.y[slot], s.phi[slot]));
+		for(std::size_t slot = 0; slot < n; ++slot) {
+			findNearestNeighbour(s, static_cast<std::int32_t>(slot));
+			push(s, static_cast<std::int32_t>(slot));
+		}
+
+		std::vector<std::int32_t>& finished = s.finished;
+		finished.clear();
+		std::size_t remaining = n;
+		while(remaining > 0) {
+			std::pop_heap(s.heap.begin(), s.heap.end(), std::greater<HeapEntry>());
+			const HeapEntry top = s.heap.back();
+			s.heap.pop_back();
+			const std::int32_t i = top.jet;
+			if(!s.alive[i] || top.version != s.version[i])
+				continue;
+
+			const std::int32_t j = s.nn[i];
+			if(j < 0) {
+				// Closest to the beam: i is a finished jet
+				remove(s, i);
+				s.alive[i] = 0;
+				--remaining;
+				finished.push_back(i);
+				gatherCandidates(s, {s.tile[i]});
+				for(std::int32_t k : s.candidates) {
+					if(s.nn[k] == i) {
+						findNearestNeighbour(s, k);
+						push(s, k);
+					}
+				}
+				continue;
+			}
+
+			// Recombine j into i with the E scheme
+			const std::int32_t oldTileI = s.tile[i], oldTileJ = s.tile[j];
+			remove(s, i);
+			remove(s, j);
+			s.alive[j] = 0;
+			s.parent[j] = i;
+			--remaining;
+			s.e[i] += s.e[j];
+			s.px[i] += s.px[j];
+			s.py[i] += s.py[j];
+			s.pz[i] += s.pz[j];
+			if(s.px[i] == 0.0 && s.py[i] == 0.0) {
+				// Back to back in the transverse plane: the recombined jet lies on the beam axis and is dropped
+				s.alive[i] = 0;
+				--remaining;
+				gatherCandidates(s, {oldTileI, oldTileJ});
+				for(std::int32_t k : s.candidates) {
+					if(s.nn[k] == i || s.nn[k] == j) {
+						findNearestNeighbour(s, k);
+						push(s, k);
+					}
+				}
+				continue;
+			}
+			setKinematics(s, i);
+			insert(s, i, tileOf(s, s.y[i], s.phi[i]));
+
+			gatherCandidates(s, {oldTileI, oldTileJ, s.tile[i]});
+			for(std::int32_t k : s.candidates) {
+				if(k == i)
+					continue;
+				if(s.nn[k] == i || s.nn[k] == j) {
+					findNearestNeighbour(s, k);
+					push(s, k);
+				}
+				else {
+					const double d = distance2(s, k, i);
+					if(d < s.nnDistance[k]) {
+						s.nn[k] = i;
+						s.nnDistance[k] = d;
+						push(s, k);
+					}
+				}
+			}
+			findNearestNeighbour(s, i);
+			push(s, i);
+		}
+
+		// Keep jets above ptMin, ordered by decreasing transverse momentum
+		const double ptMin2 = m_definition.ptMin * m_definition.ptMin;
+		finished.erase(std::remove_if(finished.begin(), finished.end(), [&](std::int32_t slot) {
+			return s.px[slot] * s.px[slot] + s.py[slot] * s.py[slot] < ptMin2;
+		}), finished.end());
+		std::sort(finished.begin(), finished.end(), [&](std::int32_t a, std::int32_t b) {
+			return s.px[a] * s.px[a] + s.py[a] * s.py[a] > s.px[b] * s.px[b] + s.py[b] * s.py[b];
+		});
+		for(std::size_t index = 0; index < finished.size(); ++index) {
+			const std::int32_t slot = finished[index];
+			s.jetIndex[slot] = static_cast<std::int32_t>(index);
+			jets.push_back(s.e[slot], s.px[slot], s.py[slot], s.pz[slot]);
+		}
+
+		if(jetOf) {
+			std::fill(jetOf, jetOf + (last - first), -1);
+			for(std::size_t slot = 0; slot < n; ++slot) {
+				// Follow the recombination history to the slot that holds the final jet
+				std::int32_t root = static_cast<std::int32_t>(slot);
+				while(s.parent[root] != root)
+					root = s.parent[root];
+				jetOf[s.inputRow[slot]] = s.jetIndex[root];
+			}
+		}
+	}
+
+	static void checkOffsets(const FourMomentumBatch& particles, const std::vector<std::uint32_t>& eventOffsets) {
+		if(eventOffsets.empty() || eventOffsets.front() != 0 || eventOffsets.back() != particles.size()
+		   || !std::is_sorted(eventOffsets.begin(), eventOffsets.end()))
+			throw std::invalid_argument("Event offsets must rise from 0 to the number of particles.");
+	}
+
+public:
+	explicit JetClusterer(JetDefinition definition = JetDefinition())
+		: m_definition(definition), m_radius2(definition.radius * definition.radius) {
+		m_definition.validate();
+	}
+
+	const JetDefinition& definition() const { return m_definition; }
+
+	// Cluster one event, returning its jets in decreasing transverse momentum
+	std::vector<FourMomentum> cluster(const FourMomentumBatch& particles) {
+		FourMomentumBatch jets;
+		clusterEvent(m_scratch, particles, 0, particles.size(), jets, nullptr);
+		std::vector<FourMomentum> out;
+		out.reserve(jets.size());
+		for(std::size_t i = 0; i < jets.size(); ++i)
+			out.push_back(jets[i].to_four_momentum());
+		return out;
+	}
+
+	// Cluster the final-state particles of one event, e.g. the quarks and gluons of a parton-level event
+	std::vector<FourMomentum> cluster(const std::vector<std::shared_ptr<Particle>>& particles) {
+		FourMomentumBatch momenta;
+		momenta.reserve(particles.size());
+		for(const auto& particle : particles) {
+			if(particle)
+				momenta.push_back(particle->getFourMomentum());
+		}
+		return cluster(momenta);
+	}
+
+	// Cluster many events stored back to back, event e being rows [eventOffsets[e], eventOffsets[e + 1])
+	JetCollection cluster(const FourMomentumBatch& particles, const std::vector<std::uint32_t>& eventOffsets) {
+		TRACE_SPAN_ARG("JetClusterer::cluster", "jets", eventOffsets.size() - 1);
+		checkOffsets(particles, eventOffsets);
+		JetCollection out;
+		out.jetOf.resize(particles.size());
+		for(std::size_t event = 0; event + 1 < eventOffsets.size(); ++event) {
+			clusterEvent(m_scratch, particles, eventOffsets[event], eventOffsets[event + 1], out.jets, out.jetOf.data() + eventOffsets[event]);
+			out.offsets.push_back(static_cast<std::uint32_t>(out.jets.size()));
+		}
+		return out;
+	}
+
+	// As above, with the events split across the pool in chunks of grain events. Each chunk clusters into its own
+	// collection, and the chunks are concatenated in event order.
+	JetCollection cluster(const FourMomentumBatch& particles, const std::vector<std::uint32_t>& eventOffsets, WorkStealingPool& pool,
+	                      std::size_t grain = 16) {
+		TRACE_SPAN_ARG("JetClusterer::cluster", "jets", eventOffsets.size() - 1);
+		checkOffsets(particles, eventOffsets);
+		const std::size_t events = eventOffsets.size() - 1;
+		grain = std::max<std::size_t>(1, grain);
+		std::vector<JetCollection> chunks((events + grain - 1) / grain);
+		JetCollection out;
+		out.jetOf.resize(particles.size());
+		pool.parallelFor(0, events, grain, [&](std::size_t begin, std::size_t end) {
+			thread_local Scratch scratch;
+			JetCollection& chunk = chunks[begin / grain];
+			for(std::size_t event = begin; event < end; ++event) {
+				clusterEvent(scratch, particles, eventOffsets[event], eventOffsets[event + 1], chunk.jets, out.jetOf.data() + eventOffsets[event]);
+				chunk.offsets.push_back(static_cast<std::uint32_t>(chunk.jets.size()));
+			}
+		});
+
+		std::size_t total = 0;
+		for(const auto& chunk : chunks)
+			total += chunk.jets.size();
+		out.jets.reserve(total);
+		for(const auto& chunk : chunks) {
+			const std::uint32_t base = out.offsets.back();
+			for(std::size_t i = 0; i < chunk.jets.size(); ++i)
+				out.jets.push_back(chunk.jets[i].to_four_momentum());
+			for(std::size_t e = 1; e < chunk.offsets.size(); ++e)
+				out.offsets.push_back(base + chunk.offsets[e]);
+		}
+		return out;
+	}
+};
+
+#endif // JET_CLUSTERING_HPP
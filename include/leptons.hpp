@@ -1,28 +1,35 @@
 // Project-2 - Luca Vicaria - PHYS30762
 // This file defines lepton classes and their specific behaviors in the particle simulation.
 // It manages lepton properties, interactions, and anti-particle conversions.
-// Last modified 08/05/2024
+// Last modified 16/10/2026
 
 #ifndef LEPTONS_HPP
 #define LEPTONS_HPP
 
+#include <array>
 #include <iostream>
-#include <map>
 #include <string>
-#include <sstream>
-#include <random>
 #include <memory>
 
+#include "calorimeter.hpp"
+#include "decay_modes.hpp"
 #include "particle.hpp"
+#include "phase_space.hpp"
+#include "random_service.hpp"
 #include "quarks.hpp"
 
-// Define properties for Leptons
+// Numeric lepton properties, indexed by LeptonType
 template <>
-std::map<LeptonType, std::map<std::string, std::string>> GenericParticle<LeptonType>::m_staticProps {
-	{LeptonType::Electron, {{"name", "Electron"}, {"mass", "0.511"}, {"charge", "-1"}, {"spin", "0.5"}}},
-	{LeptonType::Muon, {{"name", "Muon"}, {"mass", "105.66"}, {"charge", "-1"}, {"spin", "0.5"}}},
-	{LeptonType::Tau, {{"name", "Tau"}, {"mass", "1776.8"}, {"charge", "-1"}, {"spin", "0.5"}}},
-	{LeptonType::Neutrino, {{"name", "Neutrino"}, {"mass", "0"}, {"charge", "0"}, {"spin", "0.5"}}}};
+struct ParticlePropertyTable<LeptonType> {
+	static constexpr std::array<ParticleProperties, 4> values{{
+		{"Electron", 0.511, -3, 1, 11},
+		{"Muon", 105.66, -3, 1, 13},
+		{"Tau", 1776.8, -3, 1, 15},
+		{"Neutrino", 0.0, 0, 1, 12} // Electron neutrino, Neutrino::getPdgId() picks the flavour
+	}};
+
+	static constexpr const ParticleProperties& get(LeptonType type) { return values[static_cast<std::size_t>(type)]; }
+};
 
 // Enumeration for different lepton types
 enum class NeutrinoType {
@@ -42,7 +49,7 @@ class Quark;
 class Lepton : public GenericParticle<LeptonType> {
 public:
 	// Parameterized constructor
-	Lepton(LeptonType type, std::shared_ptr<FourMomentum> fourMomentum, bool isAntiParticle = false)
+	Lepton(LeptonType type, ParticleMomentum fourMomentum, bool isAntiParticle = false)
 		: GenericParticle<LeptonType>(type, fourMomentum, isAntiParticle) {
 		if(type == LeptonType::Electron || type == LeptonType::Muon || type == LeptonType::Tau || type == LeptonType::Neutrino)
 			m_leptonNumber = isAntiParticle ? -1 : 1;
@@ -77,84 +84,60 @@ public:
 		return *this;
 	}
 
-  // override the getInfo method to include the lepton number
-	virtual std::string getInfo() const override {
-		std::string baseInfo = GenericParticle::getInfo(); // Get the base class information
-		std::stringstream ss;
-		ss<<baseInfo
-		  <<", Lepton Number="<<m_leptonNumber;
-		return ss.str();
-	}
-
 	int getLeptonNumber() const { return m_leptonNumber; }
+
+protected:
+	// Include the lepton number in the particle information
+	void formatFields(ParticleFieldWriter& writer) const override {
+		GenericParticle::formatFields(writer);
+		writer.field("lepton_number", "Lepton Number", m_leptonNumber);
+	}
 };
 
 class Electron : public Lepton {
 private:
-	std::vector<double> m_layerEnergies; // Stores energy deposited in each of four calorimeter layers
+	std::vector<double> m_layerEnergies; // Stores energy deposited in each calorimeter layer
 
-	// Randomly distribute total energy from FourMomentum across four calorimeter layers
+	// Distribute the total energy across the layers of the standard calorimeter following the electron shower profile
 	void distributeEnergy() {
-		if(!m_fourMomentum)
-			return; // Ensure FourMomentum is present
-
-		double totalEnergy = m_fourMomentum->get_energy();
-		std::default_random_engine generator(std::random_device{}());
-		std::uniform_real_distribution<double> distribution(0.0, 1.0);
-
-		double sumFrac = 0.0;
-		std::vector<double> fractions(3);
-		for(int i = 0; i < 3; ++i) {
-			fractions[i] = distribution(generator);
-			sumFrac += fractions[i];
-		}
-
-		double cumulativeEnergy = 0.0;
-		for(int i = 0; i < 3; ++i) {
-			m_layerEnergies[i] = (fractions[i] / sumFrac) * totalEnergy;
-			cumulativeEnergy += m_layerEnergies[i];
-		}
-
-		m_layerEnergies[3] = totalEnergy - cumulativeEnergy; // Ensure exact energy conservation
+		const double totalEnergy = m_fourMomentum.get().get_energy();
+		ShowerProfile::standard().fractions(totalEnergy, ShowerType::Electron, m_layerEnergies.data());
+		for(double& energy : m_layerEnergies)
+			energy *= totalEnergy;
 	}
 
 public:
 	// Constructor
-	Electron(std::shared_ptr<FourMomentum> fourMomentum, bool isAntiParticle = false)
-		: Lepton(LeptonType::Electron, fourMomentum, isAntiParticle), m_layerEnergies(4, 0.0) {
-		if(fourMomentum)
-			distributeEnergy();
+	Electron(ParticleMomentum fourMomentum, bool isAntiParticle = false)
+		: Lepton(LeptonType::Electron, std::move(fourMomentum), isAntiParticle), m_layerEnergies(ShowerProfile::standard().layers(), 0.0) {
+		distributeEnergy();
 	}
 
 	std::shared_ptr<Particle> getAntiParticle() const override {
-		auto antiParticle = std::make_shared<Electron>(m_fourMomentum, !m_isAntiParticle);
+		auto antiParticle = makeEventShared<Electron>(m_fourMomentum.get(), !m_isAntiParticle);
 		antiParticle->m_layerEnergies = m_layerEnergies; // Copy the energy values to the antiparticle
 		return std::static_pointer_cast<Particle>(antiParticle);
 	}
 
-	std::string getInfo() const override {
-		std::string info = Lepton::getInfo();
-		std::stringstream ss;
-		ss<<info<<", Calorimeter Energies=[";
-		for(size_t i = 0; i < m_layerEnergies.size(); ++i) {
-			ss<<m_layerEnergies[i] << (i < m_layerEnergies.size() - 1 ? ", " : "");
-		}
-		ss<<"]";
-		return ss.str();
+protected:
+	void formatFields(ParticleFieldWriter& writer) const override {
+		Lepton::formatFields(writer);
+		writer.list("calorimeter_energies", "Calorimeter Energies", m_layerEnergies.size(), [this](std::size_t i) { return m_layerEnergies[i]; });
 	}
 };
 
 class Muon : public Lepton {
 private:
 	bool m_isIsolated; // Isolation variable specific to muons
+	double m_coneSumPt = -1.0; // Transverse momentum of other particles in the isolation cone, negative until computed
 
 public:
 	// Parameterized constructor with isolation variable
-	Muon(std::shared_ptr<FourMomentum> fourMomentum, bool isAntiParticle = false, bool isIsolated = false)
+	Muon(ParticleMomentum fourMomentum, bool isAntiParticle = false, bool isIsolated = false)
 		: Lepton(LeptonType::Muon, fourMomentum, isAntiParticle), m_isIsolated(isIsolated) {}
 
 	virtual std::shared_ptr<Particle> getAntiParticle() const override {
-		auto antiParticle = std::make_shared<Muon>(m_fourMomentum, !m_isAntiParticle, m_isIsolated);
+		auto antiParticle = makeEventShared<Muon>(m_fourMomentum.get(), !m_isAntiParticle, m_isIsolated);
 		return std::static_pointer_cast<Particle>(antiParticle);
 	}
 
@@ -163,20 +146,34 @@ public:
 		return m_isIsolated;
 	}
 
-	virtual std::string getInfo() const override {
-		std::stringstream ss;
-		ss<<Lepton::getInfo()<<", Isolation: "<<(m_isIsolated ? "Yes" : "No");
-		return ss.str();
+	// Store isolation computed from the event, see MuonIsolation in isolation.hpp
+	void setIsolation(double coneSumPt, bool isIsolated) {
+		m_coneSumPt = coneSumPt;
+		m_isIsolated = isIsolated;
+	}
+
+	bool hasComputedIsolation() const { return m_coneSumPt >= 0.0; }
+	double getConeSumPt() const { return m_coneSumPt; }
+
+protected:
+	void formatFields(ParticleFieldWriter& writer) const override {
+		Lepton::formatFields(writer);
+		if(writer.style() == FormatStyle::Text)
+			writer.field("isolated", "Isolation", m_isIsolated ? "Yes" : "No", TextLabel::Colon);
+		else
+			writer.field("isolated", "Isolated", m_isIsolated);
+		if(hasComputedIsolation())
+			writer.field("cone_sum_pt", "Cone Sum pT", m_coneSumPt);
 	}
 };
 
 class Tau : public Lepton {
 public:
-	Tau(std::shared_ptr<FourMomentum> fourMomentum, bool isAntiParticle = false)
+	Tau(ParticleMomentum fourMomentum, bool isAntiParticle = false)
 		: Lepton(LeptonType::Tau, fourMomentum, isAntiParticle) { selectDecayMode(); }
 
 	std::shared_ptr<Particle> getAntiParticle() const override {
-		auto antiParticle = std::make_shared<Tau>(m_fourMomentum, !m_isAntiParticle);
+		auto antiParticle = makeEventShared<Tau>(m_fourMomentum.get(), !m_isAntiParticle);
 		return antiParticle;
 	}
 
@@ -185,72 +182,95 @@ public:
 	void setDecayParticles(const std::vector<std::shared_ptr<Particle>> &decayParticles) {		
 		m_decayParticles.clear();
 		
-		if(validateDecayParticles(decayParticles))		
+		if(validateDecayParticles(decayParticles)) {
+			METRICS_INCREMENT(DecaysAccepted);
 			std::copy(decayParticles.begin(), decayParticles.end(), std::back_inserter(m_decayParticles));
-		else
+		}
+		else {
+			METRICS_INCREMENT(DecaysRejected);
 			std::cerr<<"\nInvalid decay particles for Tau"<<std::endl;
-	}
-
-	std::string getInfo() const override {
-		std::string baseInfo = Lepton::getInfo();
-		std::stringstream ss;
-		ss<<baseInfo;
-		// Only add decay particle info if there are any decay particles
-		if(!m_decayParticles.empty()) {
-			ss<<", Decay Particles: ";
-			for(const auto &particle : m_decayParticles) {
-				ss<<particle->getName()<<", ";
-			}
-			// Remove the last comma and space
-			std::string result = ss.str();
-			return result.substr(0, result.size() - 2);
 		}
+	}
 
-		return ss.str();
+protected:
+	void formatFields(ParticleFieldWriter& writer) const override {
+		Lepton::formatFields(writer);
+		formatDecayParticles(writer);
 	}
 
 private:
-	// Randomly select and populate decay particles using a single RNG
+	// Every registered tau mode is three-body, matching decayMomenta
+	static_assert([] {
+		for(const DecayMode& mode : DecayModeRegistry::modesOf(15)) {
+			if(mode.daughterCount != 3)
+				return false;
+		}
+		return true;
+	}(), "Tau decay modes must have three daughters");
+
+	// Select a decay mode weighted by branching ratio and populate the decay particles, using the current stream of the random service
 	void selectDecayMode() {
-		static std::random_device rd;  // Static to use the same random device
-		static std::mt19937 gen(rd()); // Static to use the same generator, seeded once
-		std::uniform_int_distribution<> dis(1, 2);
+		const int pdgId = getPdgId();
+		const DecayMode& mode = DecayModeSampler::of(pdgId).sample(RandomService::current());
+		std::array<int, 3> ids{};
+		std::array<double, 3> masses{};
+		for(std::size_t i = 0; i < 3; ++i) {
+			ids[i] = DecayModeRegistry::daughterOf(mode, i, pdgId);
+			masses[i] = daughterMass(ids[i]);
+		}
+		auto momenta = decayMomenta(masses[0], masses[1], masses[2]);
+		for(std::size_t i = 0; i < 3; ++i)
+			m_decayParticles.push_back(makeDaughter(ids[i], momenta[i]));
+	}
 
-		if(dis(gen) == 1)
-			decayLeptonic();
-		else
-			decayHadronic();
+	// Share the tau's four-momentum between three daughters of the given masses using three-body phase space.
+	// If the tau's four-momentum is below threshold the daughters are left at rest.
+	std::array<FourMomentum, 3> decayMomenta(double m1, double m2, double m3) const {
+		std::array<FourMomentum, 3> momenta{FourMomentum(m1, 0, 0, 0), FourMomentum(m2, 0, 0, 0), FourMomentum(m3, 0, 0, 0)};
+		PhaseSpaceGenerator phaseSpace{m1, m2, m3};
+		if(phaseSpace.isAllowed(m_fourMomentum.get()))
+			phaseSpace.generate(m_fourMomentum.get(), RandomService::current(), momenta.data());
+		return momenta;
 	}
 
-	// Decay to a lepton (muon) and corresponding antineutrino, and a tau antineutrino as this is the most probable and stable decay mode
-	void decayLeptonic() {
-		m_decayParticles.push_back(std::static_pointer_cast<Particle>(std::make_shared<Muon>(std::make_shared<FourMomentum>(105.66, 0, 0, 0), m_isAntiParticle)));
-		m_decayParticles.push_back(std::static_pointer_cast<Particle>(std::make_shared<Neutrino>(NeutrinoType::MuonNeutrino, std::make_shared<FourMomentum>(0, 0, 0, 0), !m_isAntiParticle, false)));
-		m_decayParticles.push_back(std::static_pointer_cast<Particle>(std::make_shared<Neutrino>(NeutrinoType::TauNeutrino, std::make_shared<FourMomentum>(0, 0, 0, 0), m_isAntiParticle, false)));
+	// The particles a tau can decay into: charged leptons, neutrinos and quarks
+	static double daughterMass(int pdgId) {
+		const int id = pdgId < 0 ? -pdgId : pdgId;
+		if(id == 11)
+			return ParticlePropertyTable<LeptonType>::get(LeptonType::Electron).mass;
+		if(id == 13)
+			return ParticlePropertyTable<LeptonType>::get(LeptonType::Muon).mass;
+		if(id == 12 || id == 14 || id == 16)
+			return 0.0;
+		return ParticlePropertyTable<QuarkType>::get(Quark::typeOfPdgId(id)).mass;
 	}
 
-	// Decay to two quarks (up and anti-up) and a tau antineutrino as this is the most probable and stable decay mode
-	void decayHadronic() {
-		m_decayParticles.push_back(std::static_pointer_cast<Particle>(std::make_shared<Quark>(QuarkType::UpQuark, ColourCharge::Red, std::make_shared<FourMomentum>(2.2, 0, 0, 0), m_isAntiParticle)));
-		m_decayParticles.push_back(std::static_pointer_cast<Particle>(std::make_shared<Quark>(QuarkType::UpQuark, ColourCharge::AntiRed, std::make_shared<FourMomentum>(2.2, 0, 0, 0), !m_isAntiParticle)));
-		m_decayParticles.push_back(std::static_pointer_cast<Particle>(std::make_shared<Neutrino>(NeutrinoType::TauNeutrino, std::make_shared<FourMomentum>(0, 0, 0, 0), m_isAntiParticle, false)));
+	static std::shared_ptr<Particle> makeDaughter(int pdgId, const FourMomentum& momentum) {
+		const bool anti = pdgId < 0;
+		const int id = anti ? -pdgId : pdgId;
+		if(id == 11)
+			return std::static_pointer_cast<Particle>(makeEventShared<Electron>(momentum, anti));
+		if(id == 13)
+			return std::static_pointer_cast<Particle>(makeEventShared<Muon>(momentum, anti));
+		if(id == 12 || id == 14 || id == 16)
+			return std::static_pointer_cast<Particle>(makeEventShared<Neutrino>(static_cast<NeutrinoType>((id - 12) / 2), momentum, anti, false));
+		return std::static_pointer_cast<Particle>(makeEventShared<Quark>(Quark::typeOfPdgId(id), anti ? ColourCharge::AntiRed : ColourCharge::Red, momentum, anti));
 	}
 
-	// Validation checks
+	// Validation checks. The registry lookup rejects unlisted final states before the per-law checks run.
 	bool validateDecayParticles(const std::vector<std::shared_ptr<Particle>> &decayParticles) {
 		return decayParticles.size() == 3 &&
+					 DecayModeRegistry::isAllowed(*this, decayParticles) &&
 					 checkChargeConservation(decayParticles) &&
 					 checkLeptonNumberConservation(decayParticles) &&
 					 checkBaryonNumberConservation(decayParticles);
 		}
 
-	// Check lepton number conservation
+	// Check lepton number conservation. Only leptons carry a non-zero lepton number, so no type filter is needed.
 	bool checkLeptonNumberConservation(const std::vector<std::shared_ptr<Particle>> &decayParticles) {
 		int totalLeptonNumber = 0;
-		for (const auto &particle : decayParticles) {
-			if (particle->getType() == "Lepton")
-				totalLeptonNumber += particle->getLeptonNumber();
-		}
+		for (const auto &particle : decayParticles)
+			totalLeptonNumber += particle->getLeptonNumber();
 
 		auto result = totalLeptonNumber == getLeptonNumber();
 		if (!result)
@@ -259,15 +279,13 @@ private:
 		return result;
 	}
 
-	// Check baryon number conservation
+	// Check baryon number conservation, counted in thirds so the comparison is exact
 	bool checkBaryonNumberConservation(const std::vector<std::shared_ptr<Particle>> &decayParticles) {
-		double totalBaryonNumber = 0.0;
-		for (const auto &particle : decayParticles) {
-			if (particle->getType() == "Quark")
-				totalBaryonNumber += particle->getBaryonNumber();
-		}
+		int totalBaryonThirds = 0;
+		for (const auto &particle : decayParticles)
+			totalBaryonThirds += particle->getBaryonNumberThirds();
 
-		auto result = abs(totalBaryonNumber) < 0.1; // Allow for floating-point precision issues due to 1/3 charge of quarks
+		auto result = totalBaryonThirds == 0;
 		if (!result)
 			std::cerr << "Baryon number conservation violated for Tau decay\n" << std::endl;
 
@@ -292,7 +310,7 @@ protected:
 
 public:
 	// Constructor with interaction property
-	Neutrino(NeutrinoType type, std::shared_ptr<FourMomentum> fourMomentum, bool isAntiParticle = false, bool interactsWithDetector = false)
+	Neutrino(NeutrinoType type, ParticleMomentum fourMomentum, bool isAntiParticle = false, bool interactsWithDetector = false)
 		: Lepton(LeptonType::Neutrino, fourMomentum, isAntiParticle),
 		  m_neutrinoType(type), m_interactsWithDetector(interactsWithDetector) {}
 
@@ -310,30 +328,39 @@ public:
 		m_interactsWithDetector = interacts;
 	}
 
-	std::string getName() const override { 
-		if(m_isAntiParticle)
-			return ANTI_PREFIX + getNeutrinoTypeStr() + "-Neutrino"; 
-		else
-			return getNeutrinoTypeStr() + "-Neutrino"; 
+	// 12, 14 or 16 by flavour, negative for anti-neutrinos
+	int getPdgId() const override {
+		int id = 12 + 2 * static_cast<int>(m_neutrinoType);
+		return m_isAntiParticle ? -id : id;
+	}
+
+	std::string getName() const override { return std::string(getNameView()); }
+
+	// Names by flavour, particles then anti-particles, so no name is built per call
+	std::string_view getNameView() const override {
+		static constexpr std::string_view names[6] = {"Electron-Neutrino", "Muon-Neutrino", "Tau-Neutrino",
+		                                              "Anti-Electron-Neutrino", "Anti-Muon-Neutrino", "Anti-Tau-Neutrino"};
+		return names[static_cast<std::size_t>(m_neutrinoType) + (m_isAntiParticle ? 3 : 0)];
 	}
 
 	// Override the getAntiParticle to handle neutrino specific properties
 	virtual std::shared_ptr<Particle> getAntiParticle() const override {
-		auto antiParticle = std::make_shared<Neutrino>(m_neutrinoType, m_fourMomentum, !m_isAntiParticle, m_interactsWithDetector);
+		auto antiParticle = makeEventShared<Neutrino>(m_neutrinoType, m_fourMomentum.get(), !m_isAntiParticle, m_interactsWithDetector);
 		return std::static_pointer_cast<Particle>(antiParticle);
 	}
 
-	// Override to provide information specific to Neutrinos
-	virtual std::string getInfo() const override {
-		std::stringstream ss;
-		ss<<Lepton::getInfo()<<", Interacts with Detector="<<std::boolalpha<<m_interactsWithDetector;
-		return ss.str();
-	}
 
 	// Get the neutrino type as a string
 	std::string getNeutrinoTypeStr() const {
 		return  m_neutrinoType == NeutrinoType::ElectronNeutrino ? "Electron" : m_neutrinoType == NeutrinoType::MuonNeutrino ? "Muon"																																		 : "Tau";
 	}
+
+protected:
+	// Include the detector interaction flag specific to neutrinos
+	void formatFields(ParticleFieldWriter& writer) const override {
+		Lepton::formatFields(writer);
+		writer.field("interacts_with_detector", "Interacts with Detector", m_interactsWithDetector);
+	}
 };
 
 #endif // LEPTONS_HPP
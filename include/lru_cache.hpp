@@ -0,0 +1,91 @@
+// Project-2 - Luca Vicaria - PHYS30762
+// This file defines a thread-safe least-recently-used cache.
+// Entries live in a list ordered from most to least recently used, with a hash map from key to list position,
+// so lookups, insertions and evictions are all O(1).
+// Last modified 16/10/2026
+
+#ifndef LRU_CACHE_HPP
+#define LRU_CACHE_HPP
+
+#include <cstddef>
+#include <functional>
+#include <list>
+#include <mutex>
+#include <unordered_map>
+#include <utility>
+
+template <typename Key, typename Value, typename Hash = std::hash<Key>>
+class LruCache {
+private:
+	using Entry = std::pair<Key, Value>;
+
+	std::size_t m_capacity;
+	std::list<Entry> m_entries; // Front is the most recently used
+	std::unordered_map<Key, typename std::list<Entry>::iterator, Hash> m_index;
+	mutable std::mutex m_mutex;
+	std::size_t m_hits = 0;
+	std::size_t m_misses = 0;
+
+public:
+	explicit LruCache(std::size_t capacity) : m_capacity(capacity) {
+		m_index.reserve(capacity);
+	}
+
+	// Copy the cached value into value and mark it as most recently used, returning false on a miss
+	bool get(const Key& key, Value& value) {
+		std::lock_guard<std::mutex> lock(m_mutex);
+		auto it = m_index.find(key);
+		if(it == m_index.end()) {
+			++m_misses;
+			return false;
+		}
+		m_entries.splice(m_entries.begin(), m_entries, it->second);
+		value = it->second->second;
+		++m_hits;
+		return true;
+	}
+
+	// Insert or replace a value, evicting the least recently used entry when full
+	void put(const Key& key, Value value) {
+		if(m_capacity == 0)
+			return;
+		std::lock_guard<std::mutex> lock(m_mutex);
+		auto it = m_index.find(key);
+		if(it != m_index.end()) {
+			it->second->second = std::move(value);
+			m_entries.splice(m_entries.begin(), m_entries, it->second);
+			return;
+		}
+		if(m_entries.size() == m_capacity) {
+			m_index.erase(m_entries.back().first);
+			m_entries.pop_back();
+		}
+		m_entries.emplace_front(key, std::move(value));
+		m_index.emplace(key, m_entries.begin());
+	}
+
+	void clear() {
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_entries.clear();
+		m_index.clear();
+	}
+
+	std::size_t size() const {
+		std::lock_guard<std::mutex> lock(m_mutex);
+		return m_entries.size();
+	}
+
+	std::size_t capacity() const { return m_capacity; }
+
+	std::size_t hits() const {
+		std::lock_guard<std::mutex> lock(m_mutex);
+		return m_hits;
+	}
+
+	std::size_t misses() const {
+		std::lock_guard<std::mutex> lock(m_mutex);
+		return m_misses;
+	}
+};
+
+#endif // LRU_CACHE_HPP
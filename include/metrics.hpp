@@ -0,0 +1,313 @@
+// Project-2 - Luca Vicaria - PHYS30762
+// This file defines the runtime metrics registry: event counters and log2-bucketed latency histograms.
+// Every thread writes to its own shard with relaxed atomic stores, so recording never contends; readers sum the
+// shards. Shards of finished threads are kept, and reused by later threads, so no counts are lost.
+// Define PARTICLE_NO_METRICS to compile every METRICS_ macro out.
+// Last modified 16/10/2026
+
+#ifndef METRICS_HPP
+#define METRICS_HPP
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace metrics {
+	enum class Counter : std::size_t {
+		ParticlesConstructed,
+		FourMomentumValidationFailures,
+		DecaysAccepted,          // setDecayParticles calls that passed the conservation checks
+		DecaysRejected,
+		DecayBatchRecords,       // Records checked by DecayValidator
+		DecayBatchViolations,    // Records with at least one violation bit set
+		CatalogueLookups,
+		CatalogueLookupMisses,
+		ArenaAllocations,
+		ArenaBytes,
+		ArenaBlocks,
+		Count
+	};
+
+	enum class Histogram : std::size_t {
+		QueryNs,                 // CatalogueQuery::answer, sampled
+		EventGenerationNs,       // EventGenerator, one event, sampled
+		DecayBatchValidationNs,  // DecayValidator::validate, one batch
+		Count
+	};
+
+	inline constexpr std::size_t COUNTER_COUNT = static_cast<std::size_t>(Counter::Count);
+	inline constexpr std::size_t HISTOGRAM_COUNT = static_cast<std::size_t>(Histogram::Count);
+	inline constexpr std::size_t BUCKET_COUNT = 48; // Bucket b holds values in [2^(b-1), 2^b), bucket 0 holds 0
+
+	inline constexpr std::array<std::string_view, COUNTER_COUNT> COUNTER_NAMES = {
+		"particles_constructed", "four_momentum_validation_failures", "decays_accepted", "decays_rejected",
+		"decay_batch_records", "decay_batch_violations", "catalogue_lookups", "catalogue_lookup_misses",
+		"arena_allocations", "arena_bytes", "arena_blocks"};
+
+	inline constexpr std::array<std::string_view, HISTOGRAM_COUNT> HISTOGRAM_NAMES = {
+		"query_ns", "event_generation_ns", "decay_batch_validation_ns"};
+
+	// Sampled timers measure one call in SAMPLE_PERIOD per thread, keeping clock reads off most fast calls
+	inline constexpr std::uint32_t SAMPLE_PERIOD = 64;
+
+	inline std::size_t bucketOf(std::uint64_t value) {
+		std::size_t bucket = 0;
+		while(value != 0 && bucket + 1 < BUCKET_COUNT) {
+			value >>= 1;
+			++bucket;
+		}
+		return bucket;
+	}
+
+	// Largest value that falls in a bucket
+	inline std::uint64_t bucketUpperBound(std::size_t bucket) { return bucket == 0 ? 0 : (std::uint64_t(1) << bucket) - 1; }
+
+	struct HistogramSnapshot {
+		std::array<std::uint64_t, BUCKET_COUNT> buckets{};
+		std::uint64_t count = 0;
+		std::uint64_t sum = 0;
+
+		double mean() const { return count ? static_cast<double>(sum) / count : 0.0; }
+
+		// Upper bound of the bucket holding the q-quantile, accurate to a factor of two
+		std::uint64_t quantile(double q) const {
+			if(count == 0)
+				return 0;
+			const std::uint64_t rank = static_cast<std::uint64_t>(q * (count - 1)) + 1;
+			std::uint64_t seen = 0;
+			for(std::size_t b = 0; b < BUCKET_COUNT; ++b) {
+				seen += buckets[b];
+				if(seen >= rank)
+					return bucketUpperBound(b);
+			}
+			return bucketUpperBound(BUCKET_COUNT - 1);
+		}
+	};
+
+	struct Snapshot {
+		std::array<std::uint64_t, COUNTER_COUNT> counters{};
+		std::array<HistogramSnapshot, HISTOGRAM_COUNT> histograms{};
+
+		std::uint64_t operator[](Counter counter) const { return counters[static_cast<std::size_t>(counter)]; }
+		const HistogramSnapshot& operator[](Histogram histogram) const { return histograms[static_cast<std::size_t>(histogram)]; }
+
+		// {"counters":{...},"histograms":{"query_ns":{"count":..,"mean":..,"p50":..,"p90":..,"p99":..,"max":..},...}}
+		std::string toJson() const {
+			std::string out = "{\"counters\":{";
+			for(std::size_t i = 0; i < COUNTER_COUNT; ++i) {
+				if(i > 0)
+					out += ',';
+				out += '"';
+				out.append(COUNTER_NAMES[i]);
+				out += "\":" + std::to_string(counters[i]);
+			}
+			out += "},\"histograms\":{";
+			for(std::size_t i = 0; i < HISTOGRAM_COUNT; ++i) {
+				const HistogramSnapshot& h = histograms[i];
+				if(i > 0)
+					out += ',';
+				out += '"';
+				out.append(HISTOGRAM_NAMES[i]);
+				out += "\":{\"count\":" + std::to_string(h.count) + ",\"mean\":" + std::to_string(h.mean()) +
+				       ",\"p50\":" + std::to_string(h.quantile(0.5)) + ",\"p90\":" + std::to_string(h.quantile(0.9)) +
+				       ",\"p99\":" + std::to_string(h.quantile(0.99)) + ",\"max\":" + std::to_string(h.quantile(1.0)) + "}";
+			}
+			out += "}}";
+			return out;
+		}
+	};
+
+	class Registry {
+	private:
+		// Written only by the thread that owns it, read by anyone
+		struct alignas(64) Shard {
+			std::array<std::atomic<std::uint64_t>, COUNTER_COUNT> counters{};
+			std::array<std::array<std::atomic<std::uint64_t>, BUCKET_COUNT>, HISTOGRAM_COUNT> buckets{};
+			std::array<std::atomic<std::uint64_t>, HISTOGRAM_COUNT> sums{};
+		};
+
+		// Single writer, so a relaxed load and store is enough and avoids a locked read-modify-write
+		static void bump(std::atomic<std::uint64_t>& value, std::uint64_t n) {
+			value.store(value.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+		}
+
+		// The calling thread's shard. A trivially destructible thread_local, so the fast path needs no guard check.
+		static inline thread_local Shard* t_shard = nullptr;
+
+		// Returns the thread's shard to the free list when the thread exits
+		struct ShardHandle {
+			Registry* registry = nullptr;
+			Shard* shard = nullptr;
+			~ShardHandle() {
+				if(shard) {
+					t_shard = nullptr;
+					registry->release(shard);
+				}
+			}
+		};
+
+		mutable std::mutex m_mutex;
+		std::vector<std::unique_ptr<Shard>> m_shards;
+		std::vector<Shard*> m_free;
+
+		Shard* acquire() {
+			std::lock_guard<std::mutex> lock(m_mutex);
+			if(!m_free.empty()) {
+				Shard* shard = m_free.back();
+				m_free.pop_back();
+				return shard;
+			}
+			m_shards.push_back(std::make_unique<Shard>());
+			return m_shards.back().get();
+		}
+
+		void release(Shard* shard) {
+			std::lock_guard<std::mutex> lock(m_mutex);
+			m_free.push_back(shard);
+		}
+
+		// First use on a thread: take a shard and arrange for it to be released at thread exit
+		static Shard& attach();
+
+		static Shard& local() {
+			Shard* shard = t_shard;
+			return shard ? *shard : attach();
+		}
+
+	public:
+		// Recording touches only the thread's own shard, so it is static and skips the registry() lookup
+		static void add(Counter counter, std::uint64_t n = 1) { bump(local().counters[static_cast<std::size_t>(counter)], n); }
+
+		static void record(Histogram histogram, std::uint64_t value) {
+			Shard& shard = local();
+			const std::size_t h = static_cast<std::size_t>(histogram);
+			bump(shard.buckets[h][bucketOf(value)], 1);
+			bump(shard.sums[h], value);
+		}
+
+		Snapshot snapshot() const {
+			Snapshot result;
+			std::lock_guard<std::mutex> lock(m_mutex);
+			for(const auto& shard : m_shards) {
+				for(std::size_t i = 0; i < COUNTER_COUNT; ++i)
+					result.counters[i] += shard->counters[i].load(std::memory_order_relaxed);
+				for(std::size_t h = 0; h < HISTOGRAM_COUNT; ++h) {
+					for(std::size_t b = 0; b < BUCKET_COUNT; ++b) {
+						const std::uint64_t n = shard->buckets[h][b].load(std::memory_order_relaxed);
+						result.histograms[h].buckets[b] += n;
+						result.histograms[h].count += n;
+					}
+					result.histograms[h].sum += shard->sums[h].load(std::memory_order_relaxed);
+				}
+			}
+			return result;
+		}
+
+		// Write the snapshot as one JSON object, throwing if the file cannot be written
+		void dumpToFile(const std::string& path) const {
+			std::unique_ptr<std::FILE, int (*)(std::FILE*)> file(std::fopen(path.c_str(), "w"), &std::fclose);
+			if(!file)
+				throw std::runtime_error("Cannot write metrics to '" + path + "'.");
+			const std::string json = snapshot().toJson();
+			std::fwrite(json.data(), 1, json.size(), file.get());
+			std::fputc('\n', file.get());
+		}
+	};
+
+	inline Registry& registry() {
+		static Registry instance;
+		return instance;
+	}
+
+	inline Registry::Shard& Registry::attach() {
+		thread_local ShardHandle handle;
+		handle.registry = &registry();
+		handle.shard = handle.registry->acquire();
+		t_shard = handle.shard;
+		return *handle.shard;
+	}
+
+	// Writes the registry to a file when destroyed, e.g. at the end of main. A null or empty path disables it.
+	class DumpOnExit {
+	private:
+		std::string m_path;
+
+	public:
+		explicit DumpOnExit(const char* path) : m_path(path ? path : "") {}
+
+		~DumpOnExit() {
+			if(m_path.empty())
+				return;
+			try {
+				registry().dumpToFile(m_path);
+			}
+			catch(const std::exception& e) {
+				std::fprintf(stderr, "%s\n", e.what());
+			}
+		}
+
+		DumpOnExit(const DumpOnExit&) = delete;
+		DumpOnExit& operator=(const DumpOnExit&) = delete;
+	};
+
+	// True once every SAMPLE_PERIOD calls on this thread
+	inline bool sampleThisCall() {
+		thread_local std::uint32_t calls = 0;
+		return calls++ % SAMPLE_PERIOD == 0;
+	}
+
+	// Records the lifetime of the scope in a histogram, in nanoseconds, if enabled
+	class ScopedTimer {
+	private:
+		Histogram m_histogram;
+		bool m_enabled;
+		std::chrono::steady_clock::time_point m_start;
+
+	public:
+		explicit ScopedTimer(Histogram histogram, bool enabled = true) : m_histogram(histogram), m_enabled(enabled) {
+			if(m_enabled)
+				m_start = std::chrono::steady_clock::now();
+		}
+
+		~ScopedTimer() {
+			if(m_enabled) {
+				const auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - m_start);
+				Registry::record(m_histogram, static_cast<std::uint64_t>(elapsed.count()));
+			}
+		}
+
+		ScopedTimer(const ScopedTimer&) = delete;
+		ScopedTimer& operator=(const ScopedTimer&) = delete;
+	};
+}
+
+#define METRICS_CONCAT_INNER(a, b) a##b
+#define METRICS_CONCAT(a, b) METRICS_CONCAT_INNER(a, b)
+
+#if defined(PARTICLE_NO_METRICS)
+#define METRICS_ADD(counter, n) ((void)0)
+#define METRICS_TIME(histogram) ((void)0)
+#define METRICS_TIME_SAMPLED(histogram) ((void)0)
+#else
+// Add n to a metrics::Counter
+#define METRICS_ADD(counter, n) ::metrics::Registry::add(::metrics::Counter::counter, (n))
+// Time the rest of the enclosing scope into a metrics::Histogram
+#define METRICS_TIME(histogram) ::metrics::ScopedTimer METRICS_CONCAT(metricsTimer, __LINE__)(::metrics::Histogram::histogram)
+// As METRICS_TIME, but only for one call in metrics::SAMPLE_PERIOD on each thread
+#define METRICS_TIME_SAMPLED(histogram) \
+	::metrics::ScopedTimer METRICS_CONCAT(metricsTimer, __LINE__)(::metrics::Histogram::histogram, ::metrics::sampleThisCall())
+#endif
+
+#define METRICS_INCREMENT(counter) METRICS_ADD(counter, 1)
+
+#endif // METRICS_HPP
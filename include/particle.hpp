@@ -1,19 +1,27 @@
 // Project-2 - Luca Vicaria - PHYS30762
 // This file contains the abstract base class for particles and a generic particle template.
 // It defines fundamental particle properties and functionalities essential across various types of particles.
-// Last modified 08/05/2024
+// Last modified 16/10/2026
 
 
 #ifndef PARTICLE_HPP
 #define PARTICLE_HPP
 
+#include <array>
+#include <cmath>
+#include <cstddef>
 #include <iostream>
-#include <map>
+#include <memory>
 #include <string>
+#include <string_view>
+#include <vector>
 #include <typeinfo>
-#include <sstream>
+#include <type_traits>
 #include <cxxabi.h>
+#include "event_arena.hpp"
 #include "four_momentum.hpp"
+#include "metrics.hpp"
+#include "particle_format.hpp"
 
 // Enumerations for different particle types
 enum class LeptonType { Electron, Muon, Tau, Neutrino };
@@ -21,26 +29,66 @@ enum class QuarkType { UpQuark, DownQuark, StrangeQuark, CharmQuark, TopQuark, B
 enum class BosonType { Photon, W, Z, Gluon, Higgs };
 enum class ForceType { Strong, Electromagnetic, Weak, Gravity, None};
 
+// Broad family of a particle, used to index catalogues without comparing type strings
+enum class ParticleCategory { Lepton, Quark, Boson, Other };
+
 const std::string ANTI_PREFIX = "Anti-";
 
+// Numeric particle properties, stored in compile-time tables so hot paths avoid string parsing
+struct ParticleProperties {
+	std::string_view name;
+	double mass;      // Rest mass in MeV
+	int chargeThirds; // Electric charge in units of e/3, e.g. +2 for the up quark
+	int twiceSpin;    // Twice the spin, e.g. 1 for fermions
+	int pdgId;        // Particle Data Group Monte Carlo number of the particle (the anti-particle is its negative)
+};
+
+// Property table for each particle family, the single source of every species' name, mass, charge and spin
+template <typename ParticleType>
+struct ParticlePropertyTable;
+
+// Immutable description of one species or its conjugate, shared by every instance of it (flyweight)
+struct ParticleDefinition {
+	std::string name;
+	std::string mass;
+	std::string charge;
+	std::string spin;
+	const ParticleProperties* properties;
+	int chargeThirds; // Sign already flipped for anti-particles
+	bool isAntiParticle;
+};
+
 // Abstract base class for all particles
 class Particle {
 public:	
 	virtual std::string getInfo() const = 0;
+	virtual void format_to(std::string& buffer, FormatStyle style = FormatStyle::Text) const = 0;
 	virtual void print() const = 0; 
 	virtual std::shared_ptr<Particle> getAntiParticle() const = 0;
 	virtual std::string getName() const = 0;
 	virtual std::string getType() const = 0;
+	// The same names as views of storage that outlives the particle, for formatting without allocation
+	virtual std::string_view getNameView() const = 0;
+	virtual std::string_view getTypeView() const = 0;
+	virtual ParticleCategory getCategory() const = 0;
 	virtual std::string getMass() const = 0;
 	virtual std::string getCharge() const = 0;
 	virtual std::string getSpin() const = 0;
+	virtual double getMassValue() const = 0;
+	virtual int getChargeThirds() const = 0;
+	virtual int getTwiceSpin() const = 0;
+	virtual int getPdgId() const = 0;
 	virtual bool isAntiParticle() const = 0;
-	virtual std::shared_ptr<FourMomentum> getFourMomentum() const = 0;
-	virtual std::vector<std::shared_ptr<Particle>> getDecayParticles() const = 0;
+	virtual const FourMomentum& getFourMomentum() const = 0;
+	virtual FourMomentum& getFourMomentum() = 0;
+	virtual bool sharesFourMomentum() const = 0;
+	virtual SharedFourMomentum shareFourMomentum() = 0;
+	virtual const std::vector<std::shared_ptr<Particle>>& getDecayParticles() const = 0;
 	virtual bool hasDecayParicles() const = 0;
 
 	virtual int getLeptonNumber() const = 0;
 	virtual double getBaryonNumber() const = 0;
+	virtual int getBaryonNumberThirds() const = 0;
 };
 
 // Generic particle template class
@@ -56,52 +104,88 @@ private:
 		return result;
 	}
 
-	double convertFractionStrToDouble(std::string fracStr) const {
-		double double_value = 0.0;
+	// Display strings derived from the numeric properties: "0.511", "+2/3" or "-1", and "0.5" or "1"
+	static std::string massText(double mass) {
+		std::string text;
+		format_detail::appendNumber(text, mass);
+		return text;
+	}
 
-		if(fracStr[0] == '+')
-			fracStr = fracStr.substr(1);
+	static std::string chargeText(int chargeThirds) {
+		if(chargeThirds == 0)
+			return "0";
+		std::string text(1, chargeThirds > 0 ? '+' : '-');
+		const int magnitude = chargeThirds > 0 ? chargeThirds : -chargeThirds;
+		text += magnitude % 3 == 0 ? std::to_string(magnitude / 3) : std::to_string(magnitude) + "/3";
+		return text;
+	}
 
-		// Check for fraction
-		if(fracStr.find('/') != std::string::npos) {
-			size_t slashPos = fracStr.find('/');
-			double numerator = std::stod(fracStr.substr(0, slashPos));
-			double denominator = std::stod(fracStr.substr(slashPos + 1));
-			double_value = (numerator / denominator);
-		}
-		else
-			double_value += std::stod(fracStr);
+	static std::string spinText(int twiceSpin) {
+		return twiceSpin % 2 == 0 ? std::to_string(twiceSpin / 2) : std::to_string(twiceSpin / 2) + ".5";
+	}
+
+	// Build the particle and anti-particle definitions for every type in the family
+	static std::vector<ParticleDefinition> buildDefinitions() {
+		const auto& table = ParticlePropertyTable<ParticleType>::values;
+		std::vector<ParticleDefinition> definitions;
+		definitions.reserve(2 * table.size());
 
-		return double_value;
+		for(std::size_t i = 0; i < table.size(); ++i) {
+			const ParticleProperties& props = table[i];
+			ParticleDefinition particle{std::string(props.name), massText(props.mass), chargeText(props.chargeThirds), spinText(props.twiceSpin), &props, props.chargeThirds, false};
+
+			// Modify the properties for anti-particles
+			ParticleDefinition antiParticle = particle;
+			if(antiParticle.charge[0] == '+')
+				antiParticle.charge = "-" + antiParticle.charge.substr(1);
+			else if(antiParticle.charge[0] == '-')
+				antiParticle.charge = "+" + antiParticle.charge.substr(1);
+			antiParticle.name = ANTI_PREFIX + antiParticle.name;
+			antiParticle.chargeThirds = -antiParticle.chargeThirds;
+			antiParticle.isAntiParticle = true;
+
+			definitions.push_back(std::move(particle));
+			definitions.push_back(std::move(antiParticle));
+		}
+		return definitions;
 	}
+
 	
 protected:
-	static std::map<ParticleType, std::map<std::string, std::string>> m_staticProps;
 	ParticleType m_type;
 	bool m_isAntiParticle;
-	std::map<std::string, std::string> m_instanceProps; 
-	std::shared_ptr<FourMomentum> m_fourMomentum;
+	const ParticleDefinition* m_definition;
+	ParticleMomentum m_fourMomentum; // By value unless constructed from a SharedFourMomentum
 	std::vector<std::shared_ptr<Particle>> m_decayParticles;
 
 	int m_leptonNumber = 0;
 	double m_baryonNumber = 0.0;
+
+	// Write the fields of this particle; derived classes extend this by calling the base version first
+	virtual void formatFields(ParticleFieldWriter& writer) const {
+		writer.field("name", "Name", getNameView());
+		writer.field("type", "Type", getTypeView());
+		writer.field("mass", "Mass", m_definition->properties->mass);
+		writer.field("charge", "Charge", m_definition->charge);
+		writer.field("spin", "Spin", m_definition->spin);
+		writer.field("four_momentum", "FourMomentum", m_fourMomentum.get());
+	}
+
+	// Decay products by name, written "Decay Particles: A, B" in text. Omitted from text when there are none, always
+	// present in JSON and CSV.
+	void formatDecayParticles(ParticleFieldWriter& writer) const {
+		if(m_decayParticles.empty() && writer.style() == FormatStyle::Text)
+			return;
+		writer.list("decay_particles", "Decay Particles", m_decayParticles.size(), [this](std::size_t i) { return m_decayParticles[i]->getNameView(); },
+		            TextLabel::Colon);
+	}
 public:
 	// Constructor
-	GenericParticle(ParticleType type, std::shared_ptr<FourMomentum> fourMomentum, bool isAntiParticle = false)
-		: m_type(type), m_isAntiParticle(isAntiParticle), m_fourMomentum(fourMomentum) {
-
-			m_instanceProps = m_staticProps[type];
-			if(isAntiParticle) {
-				// Modify the properties for anti-particles
-				if(m_instanceProps["charge"][0] == '+')
-					m_instanceProps["charge"] = "-" + m_instanceProps["charge"].substr(1);
-				else if(m_instanceProps["charge"][0] == '-')
-					m_instanceProps["charge"] = "+" + m_instanceProps["charge"].substr(1);
-				
-				m_instanceProps["name"] = ANTI_PREFIX + m_instanceProps["name"];
-			}
+	GenericParticle(ParticleType type, ParticleMomentum fourMomentum, bool isAntiParticle = false)
+		: m_type(type), m_isAntiParticle(isAntiParticle), m_definition(&definition(type, isAntiParticle)), m_fourMomentum(std::move(fourMomentum)) {
 			// Set the rest mass of the four-momentum		
-			m_fourMomentum->set_rest_mass(std::stod(this->getMass()));
+			m_fourMomentum.get().set_rest_mass(m_definition->properties->mass);
+			METRICS_INCREMENT(ParticlesConstructed);
 	}
 
 	// Destructor
@@ -112,7 +196,7 @@ public:
 			: Particle(other),
 				m_type(other.m_type),
 				m_isAntiParticle(other.m_isAntiParticle),
-				m_instanceProps(other.m_instanceProps),
+				m_definition(other.m_definition),
 				m_fourMomentum(other.m_fourMomentum),
 				m_decayParticles(other.m_decayParticles),
 				m_leptonNumber(other.m_leptonNumber),
@@ -123,7 +207,7 @@ public:
 			: Particle(std::move(other)),
 				m_type(std::move(other.m_type)),
 				m_isAntiParticle(std::move(other.m_isAntiParticle)),
-				m_instanceProps(std::move(other.m_instanceProps)),
+				m_definition(other.m_definition),
 				m_fourMomentum(std::move(other.m_fourMomentum)),
 				m_decayParticles(std::move(other.m_decayParticles)),
 				m_leptonNumber(other.m_leptonNumber),
@@ -135,7 +219,7 @@ public:
 			Particle::operator=(other);
 			m_type = other.m_type;
 			m_isAntiParticle = other.m_isAntiParticle;
-			m_instanceProps = other.m_instanceProps;
+			m_definition = other.m_definition;
 			m_fourMomentum = other.m_fourMomentum;
 			m_decayParticles = other.m_decayParticles;
 			m_leptonNumber = other.m_leptonNumber;
@@ -151,7 +235,7 @@ public:
 			Particle::operator=(std::move(other));
 			m_type = std::move(other.m_type);
 			m_isAntiParticle = std::move(other.m_isAntiParticle);
-			m_instanceProps = std::move(other.m_instanceProps);
+			m_definition = other.m_definition;
 			m_fourMomentum = std::move(other.m_fourMomentum);
 			m_leptonNumber = other.m_leptonNumber;
 			m_baryonNumber = other.m_baryonNumber;
@@ -162,15 +246,12 @@ public:
 
 	// Check if the decay particles conserve charge
 	bool checkChargeConservation(const std::vector<std::shared_ptr<Particle>>& decayParticles) const {
-		double totalCharge = 0.0;
-		for(const auto &particle : decayParticles) {
-			auto charge = convertFractionStrToDouble(particle->getCharge());
-			totalCharge += charge;
-		}
-
-		auto parent_charge = convertFractionStrToDouble(getCharge());
+		int totalChargeThirds = 0;
+		for(const auto &particle : decayParticles)
+			totalChargeThirds += particle->getChargeThirds();
 
-		auto result = abs(totalCharge - parent_charge) < 0.1; // Allow for floating-point precision issues due to 1/3 charge of quarks
+		// Charges are counted in thirds of e so the comparison is exact
+		auto result = totalChargeThirds == getChargeThirds();
 		if(!result)
 			std::cerr<<"\nCharge conservation violated!"<<std::endl;
 
@@ -179,50 +260,89 @@ public:
 
 	// Get the information of the particle
 	virtual std::string getInfo() const override {
-		std::stringstream ss;
-		ss<<"Name="<<getName()
-		  <<", Type="<<getType()
-		  <<", Mass="<<m_instanceProps.at("mass")
-		  <<", Charge="<<m_instanceProps.at("charge")
-		  <<", Spin="<<m_instanceProps.at("spin")
-		  <<", FourMomentum="<<m_fourMomentum->print_four_momentum();
-		return ss.str();
+		std::string info;
+		format_to(info);
+		return info;
 	}
 
-	// Print the information to the standard output
+	// Append the information of the particle to buffer in the given style
+	virtual void format_to(std::string& buffer, FormatStyle style = FormatStyle::Text) const override {
+		ParticleFieldWriter writer(buffer, style);
+		writer.beginRecord();
+		formatFields(writer);
+		writer.endRecord();
+	}
+
+	// Print the information to the standard output, reusing one buffer per thread
 	virtual void print() const override {
-		std::cout<<getInfo()<<std::endl;
+		thread_local std::string buffer;
+		buffer.clear();
+		format_to(buffer);
+		buffer += '\n';
+		std::cout.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
 	}
 
-	virtual std::vector<std::shared_ptr<Particle>> getDecayParticles() const override {
+	// Returned by reference: walking a decay chain neither copies the vector nor touches reference counts
+	virtual const std::vector<std::shared_ptr<Particle>>& getDecayParticles() const override {
 		return m_decayParticles;
 	}
 
 	virtual std::shared_ptr<Particle> getAntiParticle() const override { return nullptr;};
 	virtual bool hasDecayParicles() const override { return m_decayParticles.size() > 0;	}
 	virtual bool isAntiParticle() const override { return m_isAntiParticle; }
-	virtual std::string getName() const override { return m_instanceProps.at("name"); }
-
- 	// Get the particle type
-	virtual std::string getType() const override { 
-		std::string type = demangle(typeid(ParticleType).name());
-
-		if(type.find("LeptonType") != std::string::npos)
-			type = "Lepton";
-		else if(type.find("QuarkType") != std::string::npos)
-			type = "Quark";
-		else if(type.find("BosonType") != std::string::npos)
-			type = "Boson";
-		else if(type.find("ForceType") != std::string::npos)
-			type = "Force";
+	virtual std::string getName() const override { return std::string(getNameView()); }
+	virtual std::string_view getNameView() const override { return m_definition->name; }
+
+ 	// Get the particle type, demangled once per particle family
+	virtual std::string getType() const override { return std::string(getTypeView()); }
+	virtual std::string_view getTypeView() const override {
+		static const std::string type = [] {
+			std::string name = demangle(typeid(ParticleType).name());
+
+			if(name.find("LeptonType") != std::string::npos)
+				name = "Lepton";
+			else if(name.find("QuarkType") != std::string::npos)
+				name = "Quark";
+			else if(name.find("BosonType") != std::string::npos)
+				name = "Boson";
+			else if(name.find("ForceType") != std::string::npos)
+				name = "Force";
+			return name;
+		}();
 		return type; 
 	}
-	virtual std::string getCharge() const override { return m_instanceProps.at("charge"); }
-	virtual std::string getMass() const override { return m_instanceProps.at("mass"); }
-	virtual std::string getSpin() const override { return m_instanceProps.at("spin"); }
-	virtual std::shared_ptr<FourMomentum> getFourMomentum() const override { return m_fourMomentum; }
+	virtual ParticleCategory getCategory() const override {
+		if(std::is_same<ParticleType, LeptonType>::value)
+			return ParticleCategory::Lepton;
+		if(std::is_same<ParticleType, QuarkType>::value)
+			return ParticleCategory::Quark;
+		if(std::is_same<ParticleType, BosonType>::value)
+			return ParticleCategory::Boson;
+		return ParticleCategory::Other;
+	}
+	virtual std::string getCharge() const override { return m_definition->charge; }
+	virtual std::string getMass() const override { return m_definition->mass; }
+	virtual std::string getSpin() const override { return m_definition->spin; }
+	virtual double getMassValue() const override { return m_definition->properties->mass; }
+	virtual int getChargeThirds() const override { return m_definition->chargeThirds; }
+	virtual int getTwiceSpin() const override { return m_definition->properties->twiceSpin; }
+	virtual int getPdgId() const override { return m_isAntiParticle ? -m_definition->properties->pdgId : m_definition->properties->pdgId; }
+	const ParticleProperties& properties() const { return *m_definition->properties; }
+	const ParticleDefinition& getDefinition() const { return *m_definition; }
+
+	// Shared definition of a species or its conjugate, built once on first use
+	static const ParticleDefinition& definition(ParticleType type, bool isAntiParticle) {
+		static const std::vector<ParticleDefinition> definitions = buildDefinitions();
+		return definitions[2 * static_cast<std::size_t>(type) + (isAntiParticle ? 1 : 0)];
+	}
+	virtual const FourMomentum& getFourMomentum() const override { return m_fourMomentum.get(); }
+	virtual FourMomentum& getFourMomentum() override { return m_fourMomentum.get(); }
+	virtual bool sharesFourMomentum() const override { return m_fourMomentum.isShared(); }
+	// Opt in to sharing this particle's four-momentum, e.g. to construct another particle from the same object
+	virtual SharedFourMomentum shareFourMomentum() override { return m_fourMomentum.share(); }
 	virtual int getLeptonNumber() const override { return m_leptonNumber; }
 	virtual double getBaryonNumber() const override { return m_baryonNumber; }
+	virtual int getBaryonNumberThirds() const override { return static_cast<int>(std::lround(3.0 * m_baryonNumber)); }
 };
 
 #endif // PARTICLE_HPP
\ No newline at end of file
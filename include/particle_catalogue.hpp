@@ -0,0 +1,260 @@
+// Project-2 - Luca Vicaria - PHYS30762
+// This file defines the ParticleCatalogue class which owns the particles known to the simulation.
+// Besides lookup by name it keeps secondary indices by category, antiparticle flag, charge, PDG ID and mass, so counts
+// are O(1) and queries such as "mass between 1 and 10 GeV" are a binary search rather than a full scan.
+// Last modified 16/10/2026
+
+#ifndef PARTICLE_CATALOGUE_HPP
+#define PARTICLE_CATALOGUE_HPP
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <iterator>
+#include <map>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "metrics.hpp"
+#include "particle.hpp"
+#include "pdg_lookup.hpp"
+
+// Non-owning view of a contiguous run of catalogue entries. It stays valid until the catalogue is next modified.
+class ParticleView {
+public:
+	class iterator {
+	private:
+		const Particle* const* m_position;
+
+	public:
+		using iterator_category = std::random_access_iterator_tag;
+		using value_type = Particle;
+		using difference_type = std::ptrdiff_t;
+		using pointer = const Particle*;
+		using reference = const Particle&;
+
+		explicit iterator(const Particle* const* position) : m_position(position) {}
+
+		reference operator*() const { return **m_position; }
+		pointer operator->() const { return *m_position; }
+		iterator& operator++() { ++m_position; return *this; }
+		iterator operator++(int) { iterator previous = *this; ++m_position; return previous; }
+		iterator& operator--() { --m_position; return *this; }
+		iterator operator--(int) { iterator previous = *this; --m_position; return previous; }
+		iterator& operator+=(difference_type n) { m_position += n; return *this; }
+		iterator& operator-=(difference_type n) { m_position -= n; return *this; }
+		iterator operator+(difference_type n) const { return iterator(m_position + n); }
+		friend iterator operator+(difference_type n, const iterator& it) { return it + n; }
+		iterator operator-(difference_type n) const { return iterator(m_position - n); }
+		difference_type operator-(const iterator& other) const { return m_position - other.m_position; }
+		reference operator[](difference_type n) const { return *m_position[n]; }
+		bool operator==(const iterator& other) const { return m_position == other.m_position; }
+		bool operator!=(const iterator& other) const { return m_position != other.m_position; }
+		bool operator<(const iterator& other) const { return m_position < other.m_position; }
+		bool operator>(const iterator& other) const { return m_position > other.m_position; }
+		bool operator<=(const iterator& other) const { return m_position <= other.m_position; }
+		bool operator>=(const iterator& other) const { return m_position >= other.m_position; }
+	};
+
+private:
+	const Particle* const* m_begin = nullptr;
+	const Particle* const* m_end = nullptr;
+
+public:
+	ParticleView() = default;
+	ParticleView(const Particle* const* begin, const Particle* const* end) : m_begin(begin), m_end(end) {}
+
+	iterator begin() const { return iterator(m_begin); }
+	iterator end() const { return iterator(m_end); }
+	std::size_t size() const { return static_cast<std::size_t>(m_end - m_begin); }
+	bool empty() const { return m_begin == m_end; }
+	const Particle& operator[](std::size_t index) const { return *m_begin[index]; }
+};
+
+class ParticleCatalogue {
+private:
+	static constexpr std::size_t CATEGORY_COUNT = 4;
+
+	// Owns the particles; ordered so iteration is alphabetical by name
+	std::map<std::string, std::unique_ptr<Particle>, std::less<>> m_byName;
+
+	// Secondary indices holding non-owning pointers into m_byName
+	std::array<std::vector<const Particle*>, CATEGORY_COUNT> m_byCategory;
+	std::array<std::vector<const Particle*>, 2> m_byAntiParticle;
+	std::unordered_map<int, std::vector<const Particle*>> m_byChargeThirds;
+	std::unordered_map<int, std::vector<const Particle*>> m_byPdgId;
+	std::vector<double> m_masses;               // Sorted rest masses in MeV
+	std::vector<const Particle*> m_massOrder;   // Particles in the same order as m_masses
+
+	static ParticleView viewOf(const std::vector<const Particle*>& index) {
+		return ParticleView(index.data(), index.data() + index.size());
+	}
+
+	static void removeFrom(std::vector<const Particle*>& index, const Particle* particle) {
+		index.erase(std::find(index.begin(), index.end(), particle));
+	}
+
+	void addToIndices(const Particle* particle) {
+		m_byCategory[static_cast<std::size_t>(particle->getCategory())].push_back(particle);
+		m_byAntiParticle[particle->isAntiParticle() ? 1 : 0].push_back(particle);
+		m_byChargeThirds[particle->getChargeThirds()].push_back(particle);
+		m_byPdgId[particle->getPdgId()].push_back(particle);
+
+		const double mass = particle->getMassValue();
+		const auto position = std::upper_bound(m_masses.begin(), m_masses.end(), mass) - m_masses.begin();
+		m_masses.insert(m_masses.begin() + position, mass);
+		m_massOrder.insert(m_massOrder.begin() + position, particle);
+	}
+
+	void removeFromIndices(const Particle* particle) {
+		removeFrom(m_byCategory[static_cast<std::size_t>(particle->getCategory())], particle);
+		removeFrom(m_byAntiParticle[particle->isAntiParticle() ? 1 : 0], particle);
+
+		auto charge = m_byChargeThirds.find(particle->getChargeThirds());
+		removeFrom(charge->second, particle);
+		if(charge->second.empty())
+			m_byChargeThirds.erase(charge);
+
+		auto pdg = m_byPdgId.find(particle->getPdgId());
+		removeFrom(pdg->second, particle);
+		if(pdg->second.empty())
+			m_byPdgId.erase(pdg);
+
+		const auto position = std::find(m_massOrder.begin(), m_massOrder.end(), particle) - m_massOrder.begin();
+		m_masses.erase(m_masses.begin() + position);
+		m_massOrder.erase(m_massOrder.begin() + position);
+	}
+
+public:
+	using const_iterator = decltype(m_byName)::const_iterator;
+
+	ParticleCatalogue() = default;
+	ParticleCatalogue(const ParticleCatalogue&) = delete;
+	ParticleCatalogue& operator=(const ParticleCatalogue&) = delete;
+	ParticleCatalogue(ParticleCatalogue&&) = default;
+	ParticleCatalogue& operator=(ParticleCatalogue&&) = default;
+
+	// Add a particle under a unique name, throwing if the name is already taken
+	Particle& insert(std::string name, std::unique_ptr<Particle> particle) {
+		if(!particle)
+			throw std::invalid_argument("Cannot add a null particle to the catalogue.");
+		if(m_byName.find(name) != m_byName.end())
+			throw std::invalid_argument("A particle named '" + name + "' is already in the catalogue.");
+
+		Particle& stored = *particle;
+		m_byName.emplace(std::move(name), std::move(particle));
+		addToIndices(&stored);
+		return stored;
+	}
+
+	// Construct a particle in place, e.g. catalogue.emplace<Muon>("muon", fourMomentum)
+	template <typename ParticleT, typename... Args>
+	ParticleT& emplace(std::string name, Args&&... args) {
+		auto particle = std::make_unique<ParticleT>(std::forward<Args>(args)...);
+		ParticleT& stored = *particle;
+		insert(std::move(name), std::move(particle));
+		return stored;
+	}
+
+	// Remove a particle by name, returning false if there was none
+	bool erase(const std::string& name) {
+		auto it = m_byName.find(name);
+		if(it == m_byName.end())
+			return false;
+		removeFromIndices(it->second.get());
+		m_byName.erase(it);
+		return true;
+	}
+
+	// Lookup by name, returning nullptr if the name is unknown
+	const Particle* find(const std::string& name) const {
+		auto it = m_byName.find(name);
+		return it == m_byName.end() ? nullptr : it->second.get();
+	}
+
+	Particle* find(const std::string& name) {
+		auto it = m_byName.find(name);
+		return it == m_byName.end() ? nullptr : it->second.get();
+	}
+
+	// First particle added with the given PDG ID, or nullptr if there is none
+	const Particle* findPdgId(int pdgId) const {
+		auto it = m_byPdgId.find(pdgId);
+		return it == m_byPdgId.end() ? nullptr : it->second.front();
+	}
+
+	// Lookup by catalogue name, then by any name or alias known to PdgLookup, e.g. "positron", "e+" or "-11"
+	const Particle* resolve(const std::string& name) const {
+		METRICS_INCREMENT(CatalogueLookups);
+		const Particle* particle = find(name);
+		if(particle)
+			return particle;
+		int pdgId = PdgLookup::resolve(name);
+		particle = pdgId != 0 ? findPdgId(pdgId) : nullptr;
+		if(!particle)
+			METRICS_INCREMENT(CatalogueLookupMisses);
+		return particle;
+	}
+
+	const Particle& at(const std::string& name) const {
+		const Particle* particle = find(name);
+		if(!particle)
+			throw std::out_of_range("No particle named '" + name + "' in the catalogue.");
+		return *particle;
+	}
+
+	std::size_t size() const { return m_byName.size(); }
+	bool empty() const { return m_byName.empty(); }
+
+	// Iterate (name, particle) pairs in alphabetical order
+	const_iterator begin() const { return m_byName.begin(); }
+	const_iterator end() const { return m_byName.end(); }
+
+	// O(1) counts
+	std::size_t countCategory(ParticleCategory category) const { return m_byCategory[static_cast<std::size_t>(category)].size(); }
+	std::size_t countAntiParticles(bool isAntiParticle = true) const { return m_byAntiParticle[isAntiParticle ? 1 : 0].size(); }
+	std::size_t countChargeThirds(int chargeThirds) const {
+		auto it = m_byChargeThirds.find(chargeThirds);
+		return it == m_byChargeThirds.end() ? 0 : it->second.size();
+	}
+
+	// Views over the secondary indices, in insertion order
+	ParticleView ofCategory(ParticleCategory category) const { return viewOf(m_byCategory[static_cast<std::size_t>(category)]); }
+	ParticleView antiParticles(bool isAntiParticle = true) const { return viewOf(m_byAntiParticle[isAntiParticle ? 1 : 0]); }
+	ParticleView withPdgId(int pdgId) const {
+		auto it = m_byPdgId.find(pdgId);
+		return it == m_byPdgId.end() ? ParticleView() : viewOf(it->second);
+	}
+	ParticleView withChargeThirds(int chargeThirds) const {
+		auto it = m_byChargeThirds.find(chargeThirds);
+		return it == m_byChargeThirds.end() ? ParticleView() : viewOf(it->second);
+	}
+
+	// All particles in ascending order of rest mass
+	ParticleView byMass() const { return viewOf(m_massOrder); }
+
+	// Particles with minMass <= mass <= maxMass in MeV, in ascending order of mass
+	ParticleView massRange(double minMass, double maxMass) const {
+		const auto first = std::lower_bound(m_masses.begin(), m_masses.end(), minMass) - m_masses.begin();
+		const auto last = std::upper_bound(m_masses.begin(), m_masses.end(), maxMass) - m_masses.begin();
+		if(last <= first)
+			return ParticleView();
+		return ParticleView(m_massOrder.data() + first, m_massOrder.data() + last);
+	}
+
+	std::size_t countMassRange(double minMass, double maxMass) const { return massRange(minMass, maxMass).size(); }
+
+	// Sum of the four-momenta of every particle in the catalogue
+	FourMomentum totalFourMomentum() const {
+		FourMomentum total;
+		for(const auto& entry : m_byName)
+			total = total + entry.second->getFourMomentum();
+		return total;
+	}
+};
+
+#endif // PARTICLE_CATALOGUE_HPP
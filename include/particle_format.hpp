@@ -0,0 +1,267 @@
+// Project-2 - Luca Vicaria - PHYS30762
+// This file defines the streaming formatter used to describe particles as text, JSON or CSV.
+// Fields are appended straight into a caller-supplied std::string with std::to_chars, and names are passed as views
+// of the shared particle definitions, so formatting a particle allocates nothing once the buffer has grown to size.
+// Last modified 16/10/2026
+
+#ifndef PARTICLE_FORMAT_HPP
+#define PARTICLE_FORMAT_HPP
+
+#include <charconv>
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+#include "four_momentum.hpp"
+
+enum class FormatStyle {
+	Text,     // Name=Electron, Type=Lepton, ...
+	Json,     // {"name":"Electron","type":"Lepton",...}
+	Csv,      // Electron,Lepton,...
+	CsvHeader // Column names matching the Csv style: name,type,...
+};
+
+// How the text style introduces a field: "Label=value", or "Label: value" for the fields that have always been
+// written that way. Lists in the colon form are written without brackets, "Label: a, b".
+enum class TextLabel { Equals, Colon };
+
+namespace format_detail {
+	// Shortest representation that reads back to the same double
+	inline void appendNumber(std::string& out, double value) {
+		char digits[32];
+		auto result = std::to_chars(digits, digits + sizeof(digits), value);
+		out.append(digits, result.ptr);
+	}
+
+	// Six significant digits, matching the default of std::ostream
+	inline void appendNumberShort(std::string& out, double value) {
+		char digits[32];
+		auto result = std::to_chars(digits, digits + sizeof(digits), value, std::chars_format::general, 6);
+		out.append(digits, result.ptr);
+	}
+
+	inline void appendNumber(std::string& out, long long value) {
+		char digits[24];
+		auto result = std::to_chars(digits, digits + sizeof(digits), value);
+		out.append(digits, result.ptr);
+	}
+
+	// JSON string literal, escaping quotes, backslashes and control characters
+	inline void appendJsonString(std::string& out, std::string_view text) {
+		static const char hex[] = "0123456789abcdef";
+		out += '"';
+		for(char c : text) {
+			if(c == '"' || c == '\\') {
+				out += '\\';
+				out += c;
+			}
+			else if(static_cast<unsigned char>(c) < 0x20) {
+				out += "\\u00";
+				out += hex[(c >> 4) & 0xF];
+				out += hex[c & 0xF];
+			}
+			else
+				out += c;
+		}
+		out += '"';
+	}
+
+	inline bool csvNeedsQuotes(std::string_view text) {
+		return text.find_first_of(",\"\r\n") != std::string_view::npos;
+	}
+
+	// Text inside a quoted CSV field, with quotes doubled as RFC 4180 requires
+	inline void appendCsvQuoted(std::string& out, std::string_view text) {
+		for(char c : text) {
+			if(c == '"')
+				out += '"';
+			out += c;
+		}
+	}
+
+	// CSV field, quoted only when it contains a separator, quote or line break
+	inline void appendCsvField(std::string& out, std::string_view text) {
+		if(!csvNeedsQuotes(text)) {
+			out.append(text);
+			return;
+		}
+		out += '"';
+		appendCsvQuoted(out, text);
+		out += '"';
+	}
+}
+
+// Appends the fields of one record in the chosen style. Every field has a human-readable label used by the text
+// style ("Lepton Number") and a key used by the JSON and CSV styles ("lepton_number").
+class ParticleFieldWriter {
+private:
+	std::string& m_out;
+	FormatStyle m_style;
+	bool m_first = true;
+
+	void beginField(std::string_view key, std::string_view label, TextLabel form = TextLabel::Equals) {
+		if(!m_first)
+			m_out += m_style == FormatStyle::Text ? ", " : ",";
+		m_first = false;
+
+		switch(m_style) {
+			case FormatStyle::Text:
+				m_out.append(label);
+				m_out += form == TextLabel::Colon ? ": " : "=";
+				break;
+			case FormatStyle::Json:
+				m_out += '"';
+				m_out.append(key);
+				m_out += "\":";
+				break;
+			case FormatStyle::CsvHeader:
+				m_out.append(key);
+				break;
+			case FormatStyle::Csv:
+				break;
+		}
+	}
+
+public:
+	ParticleFieldWriter(std::string& out, FormatStyle style) : m_out(out), m_style(style) {}
+
+	FormatStyle style() const { return m_style; }
+
+	void beginRecord() {
+		if(m_style == FormatStyle::Json)
+			m_out += '{';
+	}
+
+	void endRecord() {
+		if(m_style == FormatStyle::Json)
+			m_out += '}';
+	}
+
+	void field(std::string_view key, std::string_view label, std::string_view value, TextLabel form = TextLabel::Equals) {
+		beginField(key, label, form);
+		if(m_style == FormatStyle::Text)
+			m_out.append(value);
+		else if(m_style == FormatStyle::Json)
+			format_detail::appendJsonString(m_out, value);
+		else if(m_style == FormatStyle::Csv)
+			format_detail::appendCsvField(m_out, value);
+	}
+
+	void field(std::string_view key, std::string_view label, const char* value, TextLabel form = TextLabel::Equals) {
+		field(key, label, std::string_view(value), form);
+	}
+
+	void field(std::string_view key, std::string_view label, double value) {
+		beginField(key, label);
+		if(m_style == FormatStyle::Text)
+			format_detail::appendNumberShort(m_out, value);
+		else if(m_style != FormatStyle::CsvHeader)
+			format_detail::appendNumber(m_out, value);
+	}
+
+	void field(std::string_view key, std::string_view label, int value) {
+		beginField(key, label);
+		if(m_style != FormatStyle::CsvHeader)
+			format_detail::appendNumber(m_out, static_cast<long long>(value));
+	}
+
+	void field(std::string_view key, std::string_view label, bool value) {
+		beginField(key, label);
+		if(m_style != FormatStyle::CsvHeader)
+			m_out += value ? "true" : "false";
+	}
+
+	// Text: (E=.., Px=.., Py=.., Pz=..); JSON: {"e":..,"px":..,"py":..,"pz":..}; CSV: four columns
+	void field(std::string_view key, std::string_view label, const FourMomentum& momentum) {
+		const double components[4] = {momentum.get_energy(), momentum.get_px(), momentum.get_py(), momentum.get_pz()};
+		static constexpr std::string_view textNames[4] = {"E=", ", Px=", ", Py=", ", Pz="};
+		static constexpr std::string_view jsonNames[4] = {"\"e\":", ",\"px\":", ",\"py\":", ",\"pz\":"};
+		static constexpr std::string_view columnSuffixes[4] = {"_e", "_px", "_py", "_pz"};
+
+		switch(m_style) {
+			case FormatStyle::Text:
+				beginField(key, label);
+				m_out += '(';
+				for(int i = 0; i < 4; ++i) {
+					m_out.append(textNames[i]);
+					format_detail::appendNumberShort(m_out, components[i]);
+				}
+				m_out += ')';
+				break;
+			case FormatStyle::Json:
+				beginField(key, label);
+				m_out += '{';
+				for(int i = 0; i < 4; ++i) {
+					m_out.append(jsonNames[i]);
+					format_detail::appendNumber(m_out, components[i]);
+				}
+				m_out += '}';
+				break;
+			case FormatStyle::Csv:
+				for(int i = 0; i < 4; ++i) {
+					beginField(key, label);
+					format_detail::appendNumber(m_out, components[i]);
+				}
+				break;
+			case FormatStyle::CsvHeader:
+				for(int i = 0; i < 4; ++i) {
+					beginField(key, label);
+					m_out.append(columnSuffixes[i]);
+				}
+				break;
+		}
+	}
+
+	// A list of count values produced by value(i), which must return a std::string_view or a double.
+	// Text: [a, b], or a, b in the colon form; JSON: an array; CSV: one field with the values separated by ';',
+	// quoted per RFC 4180 if any value contains a comma, quote or line break.
+	template <typename ValueAt>
+	void list(std::string_view key, std::string_view label, std::size_t count, ValueAt value, TextLabel form = TextLabel::Equals) {
+		beginField(key, label, form);
+		if(m_style == FormatStyle::CsvHeader)
+			return;
+
+		const bool brackets = m_style == FormatStyle::Json || (m_style == FormatStyle::Text && form == TextLabel::Equals);
+		bool quoted = false;
+		if(m_style == FormatStyle::Csv) {
+			for(std::size_t i = 0; i < count && !quoted; ++i)
+				quoted = csvNeedsQuotes(value(i));
+		}
+
+		if(brackets)
+			m_out += '[';
+		if(quoted)
+			m_out += '"';
+		for(std::size_t i = 0; i < count; ++i) {
+			if(i > 0)
+				m_out += m_style == FormatStyle::Text ? ", " : m_style == FormatStyle::Json ? "," : ";";
+			appendListValue(value(i), quoted);
+		}
+		if(quoted)
+			m_out += '"';
+		if(brackets)
+			m_out += ']';
+	}
+
+private:
+	static bool csvNeedsQuotes(std::string_view text) { return format_detail::csvNeedsQuotes(text); }
+	static bool csvNeedsQuotes(double) { return false; }
+
+	void appendListValue(std::string_view text, bool quoted) {
+		if(m_style == FormatStyle::Json)
+			format_detail::appendJsonString(m_out, text);
+		else if(quoted)
+			format_detail::appendCsvQuoted(m_out, text);
+		else
+			m_out.append(text);
+	}
+
+	void appendListValue(double number, bool) {
+		if(m_style == FormatStyle::Text)
+			format_detail::appendNumberShort(m_out, number);
+		else
+			format_detail::appendNumber(m_out, number);
+	}
+};
+
+#endif // PARTICLE_FORMAT_HPP
@@ -0,0 +1,222 @@
+// Project-2 - Luca Vicaria - PHYS30762
+// This file defines the lookup from species names to Particle Data Group Monte Carlo numbers.
+// Canonical names and aliases ("positron", "e+", "anti-electron") are placed in a perfect hash table built
+// at compile time with the hash-and-displace method, so resolving a name costs one hash and one string compare.
+// Numeric names such as "11" or "-11" are parsed directly. Matching ignores ASCII case.
+// Last modified 16/10/2026
+
+#ifndef PDG_LOOKUP_HPP
+#define PDG_LOOKUP_HPP
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+struct PdgAlias {
+	std::string_view name; // Lower case
+	int pdgId;
+};
+
+// Every accepted name. The first entry for an ID is its canonical name.
+inline constexpr std::array<PdgAlias, 84> PDG_ALIASES{{
+	{"electron", 11}, {"e-", 11}, {"e", 11},
+	{"anti-electron", -11}, {"positron", -11}, {"e+", -11},
+	{"muon", 13}, {"mu-", 13}, {"mu", 13},
+	{"anti-muon", -13}, {"antimuon", -13}, {"mu+", -13},
+	{"tau", 15}, {"tau-", 15},
+	{"anti-tau", -15}, {"tau+", -15},
+	{"electron neutrino", 12}, {"nu_e", 12},
+	{"anti-electron neutrino", -12}, {"nu_e~", -12},
+	{"muon neutrino", 14}, {"nu_mu", 14},
+	{"anti-muon neutrino", -14}, {"nu_mu~", -14},
+	{"tau neutrino", 16}, {"nu_tau", 16},
+	{"anti-tau neutrino", -16}, {"nu_tau~", -16},
+	{"down quark", 1}, {"downquark", 1}, {"d", 1},
+	{"anti-down quark", -1}, {"anti-downquark", -1}, {"d~", -1},
+	{"up quark", 2}, {"upquark", 2}, {"u", 2},
+	{"anti-up quark", -2}, {"anti-upquark", -2}, {"u~", -2},
+	{"strange quark", 3}, {"strangequark", 3}, {"s", 3},
+	{"anti-strange quark", -3}, {"anti-strangequark", -3}, {"s~", -3},
+	{"charm quark", 4}, {"charmquark", 4}, {"c", 4},
+	{"anti-charm quark", -4}, {"anti-charmquark", -4}, {"c~", -4},
+	{"bottom quark", 5}, {"bottomquark", 5}, {"b", 5},
+	{"anti-bottom quark", -5}, {"anti-bottomquark", -5}, {"b~", -5},
+	{"top quark", 6}, {"topquark", 6}, {"t", 6},
+	{"anti-top quark", -6}, {"anti-topquark", -6}, {"t~", -6},
+	{"gluon", 21}, {"g", 21}, {"anti-gluon", 21}, // The gluon is its own antiparticle
+	{"photon", 22}, {"gamma", 22},
+	{"z boson", 23}, {"zboson", 23}, {"z", 23}, {"z0", 23},
+	{"w boson", 24}, {"wboson", 24}, {"w+", 24}, {"w", 24},
+	{"anti-w boson", -24}, {"anti-wboson", -24}, {"w-", -24},
+	{"higgs boson", 25}, {"higgs", 25}, {"h", 25}, {"h0", 25}
+}};
+
+class PdgLookup {
+private:
+	static constexpr std::size_t SLOTS = 256;  // Power of two, at least the number of aliases
+	static constexpr std::size_t BUCKETS = 32; // First-level buckets, each with its own displacement
+	static constexpr int MAX_ID = 25;          // Largest |PDG ID| in the table
+
+	static constexpr char lower(char c) { return (c >= 'A' && c <= 'Z') ? static_cast<char>(c - 'A' + 'a') : c; }
+
+	// Case-insensitive FNV-1a with the displacement folded into the offset basis, followed by a final avalanche
+	static constexpr std::uint64_t hash(std::uint64_t displacement, std::string_view name) {
+		std::uint64_t h = 0xCBF29CE484222325ull ^ (displacement * 0x9E3779B97F4A7C15ull);
+		for(char c : name) {
+			h ^= static_cast<unsigned char>(lower(c));
+			h *= 0x100000001B3ull;
+		}
+		h ^= h >> 29;
+		h *= 0xBF58476D1CE4E5B9ull;
+		return h ^ (h >> 32);
+	}
+
+	struct Table {
+		std::array<std::uint16_t, BUCKETS> displacement{};
+		std::array<std::int16_t, SLOTS> slot{};                  // Index into PDG_ALIASES, or -1 for an empty slot
+		std::array<std::int16_t, 2 * MAX_ID + 1> canonical{};    // Index of the canonical alias of ID - MAX_ID, or -1
+	};
+
+	// Hash-and-displace: place the largest buckets first, searching for a displacement that maps every key of the
+	// bucket to a free slot. Runs entirely at compile time.
+	static constexpr Table build() {
+		Table table{};
+		for(auto& entry : table.slot)
+			entry = -1;
+		for(auto& entry : table.canonical)
+			entry = -1;
+
+		std::array<std::size_t, PDG_ALIASES.size()> bucketOf{};
+		std::array<std::size_t, BUCKETS> bucketSize{};
+		for(std::size_t i = 0; i < PDG_ALIASES.size(); ++i) {
+			bucketOf[i] = hash(0, PDG_ALIASES[i].name) % BUCKETS;
+			++bucketSize[bucketOf[i]];
+			auto& canonical = table.canonical[static_cast<std::size_t>(PDG_ALIASES[i].pdgId + MAX_ID)];
+			if(canonical < 0)
+				canonical = static_cast<std::int16_t>(i);
+		}
+
+		std::array<bool, BUCKETS> placed{};
+		for(std::size_t round = 0; round < BUCKETS; ++round) {
+			std::size_t bucket = 0;
+			std::size_t largest = 0;
+			for(std::size_t b = 0; b < BUCKETS; ++b) {
+				if(!placed[b] && bucketSize[b] >= largest) {
+					bucket = b;
+					largest = bucketSize[b];
+				}
+			}
+			placed[bucket] = true;
+			if(largest == 0)
+				continue;
+
+			for(std::uint16_t displacement = 1; ; ++displacement) {
+				std::array<std::size_t, PDG_ALIASES.size()> candidate{};
+				std::size_t count = 0;
+				bool fits = true;
+				for(std::size_t i = 0; i < PDG_ALIASES.size() && fits; ++i) {
+					if(bucketOf[i] != bucket)
+						continue;
+					std::size_t s = hash(displacement, PDG_ALIASES[i].name) & (SLOTS - 1);
+					fits = table.slot[s] < 0;
+					for(std::size_t j = 0; j < count && fits; ++j)
+						fits = candidate[j] != s;
+					candidate[count++] = s;
+				}
+				if(!fits)
+					continue;
+
+				count = 0;
+				for(std::size_t i = 0; i < PDG_ALIASES.size(); ++i) {
+					if(bucketOf[i] == bucket)
+						table.slot[candidate[count++]] = static_cast<std::int16_t>(i);
+				}
+				table.displacement[bucket] = displacement;
+				break;
+			}
+		}
+		return table;
+	}
+
+	static const Table TABLE;
+
+	static constexpr bool equalsIgnoreCase(std::string_view input, std::string_view lowerCase) {
+		if(input.size() != lowerCase.size())
+			return false;
+		for(std::size_t i = 0; i < input.size(); ++i) {
+			if(lower(input[i]) != lowerCase[i])
+				return false;
+		}
+		return true;
+	}
+
+	// Parse "[+-]digits", returning 0 unless the number is a known ID
+	static constexpr int parseNumeric(std::string_view name) {
+		std::size_t i = (name[0] == '-' || name[0] == '+') ? 1 : 0;
+		if(i == name.size() || name.size() - i > 3)
+			return 0;
+		int value = 0;
+		for(; i < name.size(); ++i) {
+			if(name[i] < '0' || name[i] > '9')
+				return 0;
+			value = 10 * value + (name[i] - '0');
+		}
+		value = name[0] == '-' ? -value : value;
+		return isKnown(value) ? value : 0;
+	}
+
+public:
+	// PDG ID for a name or alias, or 0 if the name is unknown
+	static constexpr int resolve(std::string_view name) {
+		if(name.empty())
+			return 0;
+		if((name[0] >= '0' && name[0] <= '9') || ((name[0] == '-' || name[0] == '+') && name.size() > 1 && name[1] >= '0' && name[1] <= '9'))
+			return parseNumeric(name);
+
+		const std::uint16_t displacement = TABLE.displacement[hash(0, name) % BUCKETS];
+		const std::int16_t index = TABLE.slot[hash(displacement, name) & (SLOTS - 1)];
+		return index >= 0 && equalsIgnoreCase(name, PDG_ALIASES[static_cast<std::size_t>(index)].name) ? PDG_ALIASES[static_cast<std::size_t>(index)].pdgId : 0;
+	}
+
+	static constexpr bool isKnown(int pdgId) {
+		return pdgId >= -MAX_ID && pdgId <= MAX_ID && TABLE.canonical[static_cast<std::size_t>(pdgId + MAX_ID)] >= 0;
+	}
+
+	// Canonical lower-case name of an ID, or an empty view if the ID is unknown
+	static constexpr std::string_view canonicalName(int pdgId) {
+		return isKnown(pdgId) ? PDG_ALIASES[static_cast<std::size_t>(TABLE.canonical[static_cast<std::size_t>(pdgId + MAX_ID)])].name : std::string_view();
+	}
+
+	// Resolve a column of names in one pass, writing 0 for unknown names
+	static void resolve(const std::string_view* names, std::size_t n, int* out) {
+		for(std::size_t i = 0; i < n; ++i)
+			out[i] = resolve(names[i]);
+	}
+
+	static void resolve(const std::string* names, std::size_t n, int* out) {
+		for(std::size_t i = 0; i < n; ++i)
+			out[i] = resolve(std::string_view(names[i]));
+	}
+
+	static std::vector<int> resolve(const std::vector<std::string>& names) {
+		std::vector<int> ids(names.size());
+		resolve(names.data(), names.size(), ids.data());
+		return ids;
+	}
+
+	static std::vector<int> resolve(const std::vector<std::string_view>& names) {
+		std::vector<int> ids(names.size());
+		resolve(names.data(), names.size(), ids.data());
+		return ids;
+	}
+};
+
+inline constexpr PdgLookup::Table PdgLookup::TABLE = PdgLookup::build();
+
+static_assert(PdgLookup::resolve("Positron") == -11 && PdgLookup::resolve("e+") == -11 && PdgLookup::resolve("-11") == -11, "PDG alias table is inconsistent");
+static_assert(PdgLookup::resolve("Wboson") == 24 && PdgLookup::resolve("upquark") == 2 && PdgLookup::resolve("unknown") == 0, "PDG alias table is inconsistent");
+
+#endif // PDG_LOOKUP_HPP
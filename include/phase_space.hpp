@@ -0,0 +1,214 @@
+// Project-2 - Luca Vicaria - PHYS30762
+// This file defines the PhaseSpaceGenerator class which gives decay products physically consistent momenta.
+// Daughter momenta are generated in the parent rest frame with the RAMBO algorithm (Kleiss, Stirling and Ellis,
+// Comput. Phys. Commun. 40 (1986) 359), corrected for the daughter masses and boosted into the lab frame,
+// so the daughters' four-momenta always sum to the parent's.
+// Last modified 16/10/2026
+
+#ifndef PHASE_SPACE_HPP
+#define PHASE_SPACE_HPP
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <initializer_list>
+#include <stdexcept>
+#include <vector>
+
+#include "four_momentum.hpp"
+#include "four_momentum_batch.hpp"
+#include "random_service.hpp"
+
+class PhaseSpaceGenerator {
+public:
+	static constexpr std::size_t MAX_DAUGHTERS = 4;
+
+private:
+	static constexpr int NEWTON_ITERATIONS = 8;
+	static constexpr std::size_t SCRATCH_COLUMNS = 6;
+
+	std::array<double, MAX_DAUGHTERS> m_masses{};
+	std::size_t m_count;
+	double m_massSum = 0.0;
+
+	// Output columns, one set per daughter, each holding one entry per parent
+	struct Columns {
+		std::array<double*, MAX_DAUGHTERS> e, x, y, z;
+	};
+
+	// Core kernel over nParents parents. Every loop runs over parents innermost on contiguous columns so the compiler can
+	// vectorise it. uniforms holds 4 * count * nParents values laid out [daughter][variable][parent], scratch 6 * nParents.
+	void kernel(std::size_t nParents, const double* pe, const double* ppx, const double* ppy, const double* ppz,
+	            const double* uniforms, const Columns& out, double* scratch) const {
+		const double twoPi = 6.283185307179586;
+		double* qe = scratch;
+		double* qx = scratch + nParents;
+		double* qy = scratch + 2 * nParents;
+		double* qz = scratch + 3 * nParents;
+		double* scale = scratch + 4 * nParents;
+		double* gamma = scratch + 5 * nParents;
+
+		for(std::size_t k = 0; k < nParents; ++k)
+			qe[k] = qx[k] = qy[k] = qz[k] = 0.0;
+
+		// Isotropic massless momenta with energies drawn from q0 * exp(-q0)
+		for(std::size_t i = 0; i < m_count; ++i) {
+			const double* u1 = uniforms + (4 * i) * nParents;
+			const double* u2 = u1 + nParents;
+			const double* u3 = u2 + nParents;
+			const double* u4 = u3 + nParents;
+			for(std::size_t k = 0; k < nParents; ++k) {
+				double cosTheta = 2.0 * u1[k] - 1.0;
+				double sinTheta = std::sqrt(1.0 - cosTheta * cosTheta);
+				double phi = twoPi * u2[k];
+				double q0 = -std::log((1.0 - u3[k]) * (1.0 - u4[k]));
+				out.e[i][k] = q0;
+				out.x[i][k] = q0 * sinTheta * std::cos(phi);
+				out.y[i][k] = q0 * sinTheta * std::sin(phi);
+				out.z[i][k] = q0 * cosTheta;
+				qe[k] += q0;
+				qx[k] += out.x[i][k];
+				qy[k] += out.y[i][k];
+				qz[k] += out.z[i][k];
+			}
+		}
+
+		// Conformal transformation taking the summed momentum to (M, 0, 0, 0) in the parent rest frame
+		for(std::size_t k = 0; k < nParents; ++k) {
+			double parentMass = std::sqrt(pe[k] * pe[k] - (ppx[k] * ppx[k] + ppy[k] * ppy[k] + ppz[k] * ppz[k]));
+			double qMass = std::sqrt(qe[k] * qe[k] - (qx[k] * qx[k] + qy[k] * qy[k] + qz[k] * qz[k]));
+			gamma[k] = qe[k] / qMass;
+			scale[k] = parentMass / qMass;
+			qx[k] = -qx[k] / qMass;
+			qy[k] = -qy[k] / qMass;
+			qz[k] = -qz[k] / qMass;
+			qe[k] = 1.0 / (1.0 + gamma[k]);
+		}
+		for(std::size_t i = 0; i < m_count; ++i) {
+			for(std::size_t k = 0; k < nParents; ++k) {
+				double bq = qx[k] * out.x[i][k] + qy[k] * out.y[i][k] + qz[k] * out.z[i][k];
+				double q0 = out.e[i][k];
+				out.x[i][k] = scale[k] * (out.x[i][k] + qx[k] * q0 + qe[k] * bq * qx[k]);
+				out.y[i][k] = scale[k] * (out.y[i][k] + qy[k] * q0 + qe[k] * bq * qy[k]);
+				out.z[i][k] = scale[k] * (out.z[i][k] + qz[k] * q0 + qe[k] * bq * qz[k]);
+				// Analytically E = x * (gamma * q0 + b.q); taking |p| instead keeps the vectors exactly light-like in floating point,
+				// which matters for light daughters of a heavy parent where E^2 - p^2 suffers cancellation
+				out.e[i][k] = std::sqrt(out.x[i][k] * out.x[i][k] + out.y[i][k] * out.y[i][k] + out.z[i][k] * out.z[i][k]);
+			}
+		}
+
+		// Rescale the momenta by xi so that sum(sqrt(m^2 + xi^2 p^2)) equals the parent mass, solved by Newton iteration
+		if(m_massSum > 0.0) {
+			double* xi = gamma;
+			double* parentMass = scale;
+			for(std::size_t k = 0; k < nParents; ++k) {
+				parentMass[k] = std::sqrt(pe[k] * pe[k] - (ppx[k] * ppx[k] + ppy[k] * ppy[k] + ppz[k] * ppz[k]));
+				double ratio = m_massSum / parentMass[k];
+				xi[k] = std::sqrt(std::max(0.0, 1.0 - ratio * ratio));
+			}
+			for(int iteration = 0; iteration < NEWTON_ITERATIONS; ++iteration) {
+				for(std::size_t k = 0; k < nParents; ++k) {
+					double f = -parentMass[k];
+					double df = 0.0;
+					for(std::size_t i = 0; i < m_count; ++i) {
+						double p2 = out.e[i][k] * out.e[i][k];
+						double energy = std::sqrt(m_masses[i] * m_masses[i] + xi[k] * xi[k] * p2);
+						f += energy;
+						df += energy > 0.0 ? xi[k] * p2 / energy : 0.0;
+					}
+					xi[k] = df > 0.0 ? xi[k] - f / df : xi[k];
+				}
+			}
+			for(std::size_t i = 0; i < m_count; ++i) {
+				for(std::size_t k = 0; k < nParents; ++k) {
+					out.e[i][k] = std::sqrt(m_masses[i] * m_masses[i] + xi[k] * xi[k] * out.e[i][k] * out.e[i][k]);
+					out.x[i][k] *= xi[k];
+					out.y[i][k] *= xi[k];
+					out.z[i][k] *= xi[k];
+				}
+			}
+		}
+
+		// Boost from the parent rest frame into the lab frame
+		for(std::size_t k = 0; k < nParents; ++k) {
+			qx[k] = ppx[k] / pe[k];
+			qy[k] = ppy[k] / pe[k];
+			qz[k] = ppz[k] / pe[k];
+		}
+		for(std::size_t i = 0; i < m_count; ++i)
+			FourMomentumBatch::boost_columns(nParents, out.e[i], out.x[i], out.y[i], out.z[i], qx, qy, qz);
+	}
+
+public:
+	explicit PhaseSpaceGenerator(std::initializer_list<double> daughterMasses)
+		: PhaseSpaceGenerator(std::vector<double>(daughterMasses)) {}
+
+	explicit PhaseSpaceGenerator(const std::vector<double>& daughterMasses) : m_count(daughterMasses.size()) {
+		if(m_count < 2 || m_count > MAX_DAUGHTERS)
+			throw std::invalid_argument("Phase space generation supports between 2 and 4 daughters.");
+		for(std::size_t i = 0; i < m_count; ++i) {
+			if(daughterMasses[i] < 0.0)
+				throw std::invalid_argument("Daughter masses must be non-negative.");
+			m_masses[i] = daughterMasses[i];
+			m_massSum += daughterMasses[i];
+		}
+	}
+
+	std::size_t daughterCount() const { return m_count; }
+
+	// A decay is possible only for a time-like parent heavier than the sum of the daughter masses
+	bool isAllowed(const FourMomentum& parent) const {
+		return parent.get_energy() > 0.0 && parent.dot_product(parent) > 0.0 && parent.invariant_mass() > m_massSum;
+	}
+
+	// Generate one decay, writing daughterCount() four-momenta to daughters
+	void generate(const FourMomentum& parent, PhiloxEngine& rng, FourMomentum* daughters) const {
+		if(!isAllowed(parent))
+			throw std::invalid_argument("Parent four-momentum is below the decay threshold.");
+
+		std::array<double, 4 * MAX_DAUGHTERS> uniforms;
+		rng.fillUniform(uniforms.data(), 4 * m_count);
+
+		std::array<double, MAX_DAUGHTERS> e, x, y, z;
+		std::array<double, SCRATCH_COLUMNS> scratch;
+		Columns out;
+		for(std::size_t i = 0; i < MAX_DAUGHTERS; ++i) {
+			out.e[i] = &e[i];
+			out.x[i] = &x[i];
+			out.y[i] = &y[i];
+			out.z[i] = &z[i];
+		}
+		const double pe = parent.get_energy(), ppx = parent.get_px(), ppy = parent.get_py(), ppz = parent.get_pz();
+		kernel(1, &pe, &ppx, &ppy, &ppz, uniforms.data(), out, scratch.data());
+
+		for(std::size_t i = 0; i < m_count; ++i)
+			daughters[i] = FourMomentum(e[i], x[i], y[i], z[i]);
+	}
+
+	// Generate one decay for every parent in the batch. daughters[i] receives the i-th daughter of every parent.
+	void generate(const FourMomentumBatch& parents, PhiloxEngine& rng, std::vector<FourMomentumBatch>& daughters) const {
+		const std::size_t nParents = parents.size();
+		for(std::size_t k = 0; k < nParents; ++k) {
+			if(!isAllowed(parents[k].to_four_momentum()))
+				throw std::invalid_argument("Parent four-momentum is below the decay threshold.");
+		}
+
+		std::vector<double> uniforms(4 * m_count * nParents);
+		rng.fillUniform(uniforms.data(), uniforms.size());
+		std::vector<double> scratch(SCRATCH_COLUMNS * nParents);
+
+		daughters.resize(m_count);
+		Columns out{};
+		for(std::size_t i = 0; i < m_count; ++i) {
+			daughters[i].resize(nParents);
+			out.e[i] = daughters[i].energy_data();
+			out.x[i] = daughters[i].px_data();
+			out.y[i] = daughters[i].py_data();
+			out.z[i] = daughters[i].pz_data();
+		}
+		kernel(nParents, parents.energy_data(), parents.px_data(), parents.py_data(), parents.pz_data(), uniforms.data(), out, scratch.data());
+	}
+};
+
+#endif // PHASE_SPACE_HPP
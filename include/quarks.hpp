@@ -1,14 +1,14 @@
 // Project-2 - Luca Vicaria - PHYS30762
 // This file includes definitions and implementations for quark particles.
 // It handles quark-specific properties, including color charge and particle interactions.
-// Last modified 08/05/2024
+// Last modified 16/10/2026
 
 #ifndef QUARKS_HPP
 #define QUARKS_HPP
 
 #include <iostream>
-#include <map>
 #include <string>
+#include <string_view>
 #include <memory>
 
 #include "particle.hpp"
@@ -17,14 +17,19 @@
 // Enumeration for colour charge
 enum class ColourCharge { Red, Green, Blue, AntiRed, AntiGreen, AntiBlue };
 
+// Numeric quark properties, indexed by QuarkType
 template <>
-std::map<QuarkType, std::map<std::string, std::string>> GenericParticle<QuarkType>::m_staticProps{
-	{QuarkType::UpQuark,      {{"name", "Up Quark"}, {"mass", "2.2"}, {"charge", "+2/3"}, {"spin", "0.5"}}},
-	{QuarkType::DownQuark,    {{"name", "Down Quark"}, {"mass", "4.7"}, {"charge", "-1/3"}, {"spin", "0.5"}}},
-	{QuarkType::StrangeQuark, {{"name", "Strange Quark"}, {"mass", "96"}, {"charge", "-1/3"}, {"spin", "0.5"}}},
-	{QuarkType::CharmQuark,   {{"name", "Charm Quark"}, {"mass", "1280"}, {"charge", "+2/3"}, {"spin", "0.5"}}},
-	{QuarkType::TopQuark,     {{"name", "Top Quark"}, {"mass", "173100"}, {"charge", "+2/3"}, {"spin", "0.5"}}},
-	{QuarkType::BottomQuark,  {{"name", "Bottom Quark"}, {"mass", "4180"}, {"charge", "-1/3"}, {"spin", "0.5"}}}
+struct ParticlePropertyTable<QuarkType> {
+	static constexpr std::array<ParticleProperties, 6> values{{
+		{"Up Quark", 2.2, 2, 1, 2},
+		{"Down Quark", 4.7, -1, 1, 1},
+		{"Strange Quark", 96.0, -1, 1, 3},
+		{"Charm Quark", 1280.0, 2, 1, 4},
+		{"Top Quark", 173100.0, 2, 1, 6},
+		{"Bottom Quark", 4180.0, -1, 1, 5}
+	}};
+
+	static constexpr const ParticleProperties& get(QuarkType type) { return values[static_cast<std::size_t>(type)]; }
 };
 
 // Specific Quark class deriving from GenericParticle
@@ -33,7 +38,7 @@ protected:
     ColourCharge m_colourCharge;
 public:
 	// Parameterized constructor
-	Quark(QuarkType type, ColourCharge colour, std::shared_ptr<FourMomentum> fourMomentum, bool isAntiParticle = false)
+	Quark(QuarkType type, ColourCharge colour, ParticleMomentum fourMomentum, bool isAntiParticle = false)
 		: GenericParticle<QuarkType>(type, fourMomentum, isAntiParticle), m_colourCharge(colour) {
 			m_baryonNumber = isAntiParticle ? -1.0 / 3 : 1.0 / 3;
 	}
@@ -69,15 +74,6 @@ public:
 		return *this;
     }
 
-    virtual std::string getInfo() const override {
-			std::string baseInfo = GenericParticle::getInfo();
-			std::stringstream ss;
-			ss<<baseInfo
-				<<", Colour Charge="<<colourChargeToString(m_colourCharge)
-				<<", Baryon Number="<<(m_isAntiParticle ? "-1/3" : "+1/3");
-			return ss.str();
-    }
-
     ColourCharge getColourCharge() const {
       return m_colourCharge;
     }
@@ -103,12 +99,26 @@ public:
 			else if(m_colourCharge == ColourCharge::AntiBlue)
 				colour = ColourCharge::Blue;
 
-			auto antiQuark = std::make_shared<Quark>(m_type, colour, m_fourMomentum, !m_isAntiParticle);
+			auto antiQuark = makeEventShared<Quark>(m_type, colour, m_fourMomentum.get(), !m_isAntiParticle);
 			return std::static_pointer_cast<Particle>(antiQuark);
     }
 
+	// Quark flavour of a PDG ID of either sign
+	static constexpr QuarkType typeOfPdgId(int pdgId) {
+		const int id = pdgId < 0 ? -pdgId : pdgId;
+		for(std::size_t i = 0; i < ParticlePropertyTable<QuarkType>::values.size(); ++i) {
+			if(ParticlePropertyTable<QuarkType>::values[i].pdgId == id)
+				return static_cast<QuarkType>(i);
+		}
+		throw std::invalid_argument("PDG ID " + std::to_string(pdgId) + " is not a quark.");
+	}
+
 	// Static method to convert colour charge to string
 	static std::string colourChargeToString(ColourCharge colour) {
+		return std::string(colourChargeName(colour));
+	}
+
+	static constexpr std::string_view colourChargeName(ColourCharge colour) {
 		switch (colour) {
 			case ColourCharge::Red: return "Red";
 			case ColourCharge::Green: return "Green";
@@ -119,6 +129,13 @@ public:
 			default: return "Unknown";
 		}
 	}
+
+protected:
+	void formatFields(ParticleFieldWriter& writer) const override {
+		GenericParticle::formatFields(writer);
+		writer.field("colour_charge", "Colour Charge", colourChargeName(m_colourCharge));
+		writer.field("baryon_number", "Baryon Number", m_isAntiParticle ? "-1/3" : "+1/3");
+	}
 };
 
 #endif // QUARKS_HPP
\ No newline at end of file
@@ -0,0 +1,168 @@
+// Project-2 - Luca Vicaria - PHYS30762
+// This file defines the central random number service used by the simulation.
+// It is built on the counter-based Philox4x32-10 generator, so independent per-thread and per-event streams
+// can be derived from a single global seed without any shared mutable state.
+// Last modified 16/10/2026
+
+#ifndef RANDOM_SERVICE_HPP
+#define RANDOM_SERVICE_HPP
+
+#include <array>
+#include <atomic>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <random>
+
+// Philox4x32-10 (Salmon et al., "Parallel random numbers: as easy as 1, 2, 3", SC11).
+// Each output block is a pure function of (key, counter), so streams are selected by the counter's upper half
+// and never overlap as long as fewer than 2^64 blocks are drawn from one stream.
+class PhiloxEngine {
+public:
+	using result_type = std::uint32_t;
+
+private:
+	static constexpr std::uint32_t M0 = 0xD2511F53u;
+	static constexpr std::uint32_t M1 = 0xCD9E8D57u;
+	static constexpr std::uint32_t W0 = 0x9E3779B9u;
+	static constexpr std::uint32_t W1 = 0xBB67AE85u;
+
+	std::array<std::uint32_t, 2> m_key;
+	std::array<std::uint32_t, 4> m_counter;
+	std::array<std::uint32_t, 4> m_block;
+	unsigned m_index = 4; // Next unused word of m_block, 4 means a new block is needed
+
+	static std::array<std::uint32_t, 4> round(const std::array<std::uint32_t, 4>& ctr, const std::array<std::uint32_t, 2>& key) {
+		std::uint64_t p0 = static_cast<std::uint64_t>(M0) * ctr[0];
+		std::uint64_t p1 = static_cast<std::uint64_t>(M1) * ctr[2];
+		return {static_cast<std::uint32_t>(p1 >> 32) ^ ctr[1] ^ key[0], static_cast<std::uint32_t>(p1),
+		        static_cast<std::uint32_t>(p0 >> 32) ^ ctr[3] ^ key[1], static_cast<std::uint32_t>(p0)};
+	}
+
+	void generateBlock() {
+		std::array<std::uint32_t, 4> ctr = m_counter;
+		std::array<std::uint32_t, 2> key = m_key;
+		for(int i = 0; i < 10; ++i) {
+			ctr = round(ctr, key);
+			key[0] += W0;
+			key[1] += W1;
+		}
+		m_block = ctr;
+		m_index = 0;
+
+		// Advance the 64-bit block counter held in the lower two words
+		if(++m_counter[0] == 0)
+			++m_counter[1];
+	}
+
+public:
+	PhiloxEngine(std::uint64_t seed, std::uint64_t stream)
+		: m_key{static_cast<std::uint32_t>(seed), static_cast<std::uint32_t>(seed >> 32)},
+		  m_counter{0, 0, static_cast<std::uint32_t>(stream), static_cast<std::uint32_t>(stream >> 32)},
+		  m_block{} {}
+
+	static constexpr result_type min() { return 0; }
+	static constexpr result_type max() { return std::numeric_limits<result_type>::max(); }
+
+	result_type operator()() {
+		if(m_index == 4)
+			generateBlock();
+		return m_block[m_index++];
+	}
+
+	// Uniform double in [0, 1) with 53 random bits
+	double uniform() {
+		std::uint64_t high = (*this)() >> 5;
+		std::uint64_t low = (*this)() >> 6;
+		return static_cast<double>((high << 26) | low) * (1.0 / 9007199254740992.0);
+	}
+
+	// Fill out[0..n) with uniform doubles in [low, high)
+	void fillUniform(double* out, std::size_t n, double low = 0.0, double high = 1.0) {
+		const double width = high - low;
+		for(std::size_t i = 0; i < n; ++i)
+			out[i] = low + width * uniform();
+	}
+
+	// Fill out[0..n) with normal deviates using the Box-Muller transform, two deviates per pair of uniforms
+	void fillNormal(double* out, std::size_t n, double mean = 0.0, double sigma = 1.0) {
+		const double twoPi = 6.283185307179586;
+		std::size_t i = 0;
+		for(; i + 2 <= n; i += 2) {
+			double radius = sigma * std::sqrt(-2.0 * std::log(1.0 - uniform()));
+			double angle = twoPi * uniform();
+			out[i] = mean + radius * std::cos(angle);
+			out[i + 1] = mean + radius * std::sin(angle);
+		}
+		if(i < n)
+			out[i] = mean + sigma * std::sqrt(-2.0 * std::log(1.0 - uniform())) * std::cos(twoPi * uniform());
+	}
+};
+
+class RandomService {
+private:
+	// Thread streams live in the upper half of the stream space so they can never collide with event streams
+	static constexpr std::uint64_t THREAD_STREAM_BIT = std::uint64_t(1) << 63;
+
+	struct ThreadState {
+		std::uint64_t seed;
+		PhiloxEngine engine;
+		PhiloxEngine* bound = nullptr; // Stream bound by a ScopedRandomStream, if any
+	};
+
+	static std::atomic<std::uint64_t>& seedStorage() {
+		static std::atomic<std::uint64_t> seed{std::random_device{}() | (static_cast<std::uint64_t>(std::random_device{}()) << 32)};
+		return seed;
+	}
+
+	static std::uint64_t nextThreadIndex() {
+		static std::atomic<std::uint64_t> counter{0};
+		return counter.fetch_add(1, std::memory_order_relaxed);
+	}
+
+	static ThreadState& threadState() {
+		thread_local std::uint64_t index = nextThreadIndex();
+		thread_local ThreadState state{globalSeed(), PhiloxEngine(globalSeed(), THREAD_STREAM_BIT | index)};
+		// Restart the thread stream if the global seed has been changed since it was created
+		if(state.seed != globalSeed()) {
+			state.seed = globalSeed();
+			state.engine = PhiloxEngine(state.seed, THREAD_STREAM_BIT | index);
+		}
+		return state;
+	}
+
+public:
+	// The global seed defaults to a single draw from std::random_device; set it explicitly for reproducible runs
+	static void setGlobalSeed(std::uint64_t seed) { seedStorage().store(seed, std::memory_order_relaxed); }
+	static std::uint64_t globalSeed() { return seedStorage().load(std::memory_order_relaxed); }
+
+	// Independent stream for one event, identical on every thread and in every run with the same global seed
+	static PhiloxEngine eventStream(std::uint64_t eventId) {
+		return PhiloxEngine(globalSeed(), eventId & ~THREAD_STREAM_BIT);
+	}
+
+	// Stream private to the calling thread
+	static PhiloxEngine& threadStream() { return threadState().engine; }
+
+	// Stream the library should draw from: the one bound by a ScopedRandomStream, otherwise the thread stream
+	static PhiloxEngine& current() {
+		ThreadState& state = threadState();
+		return state.bound ? *state.bound : state.engine;
+	}
+
+	// Binds a stream (typically an event stream) as RandomService::current() for the lifetime of the scope
+	class ScopedRandomStream {
+	private:
+		PhiloxEngine* m_previous;
+
+	public:
+		explicit ScopedRandomStream(PhiloxEngine& engine) : m_previous(threadState().bound) { threadState().bound = &engine; }
+		~ScopedRandomStream() { threadState().bound = m_previous; }
+
+		ScopedRandomStream(const ScopedRandomStream&) = delete;
+		ScopedRandomStream& operator=(const ScopedRandomStream&) = delete;
+	};
+};
+
+#endif // RANDOM_SERVICE_HPP
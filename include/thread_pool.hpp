@@ -0,0 +1,177 @@
+// Project-2 - Luca Vicaria - PHYS30762
+// This file defines a work-stealing thread pool used to spread simulation work across cores.
+// Each worker owns a task deque, runs its own tasks last-in first-out and steals the oldest task
+// from another worker when its own deque is empty.
+// Last modified 16/10/2026
+
+#ifndef THREAD_POOL_HPP
+#define THREAD_POOL_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "trace.hpp"
+
+class WorkStealingPool {
+private:
+	struct WorkerQueue {
+		std::deque<std::function<void()>> tasks;
+		std::mutex mutex;
+	};
+
+	std::vector<std::unique_ptr<WorkerQueue>> m_queues;
+	std::vector<std::thread> m_threads;
+	std::atomic<bool> m_stop{false};
+	std::atomic<std::size_t> m_pending{0};
+	std::atomic<std::size_t> m_queued{0};   // Tasks in a deque and not yet taken by a worker, raised under m_stateMutex
+	std::atomic<std::size_t> m_nextQueue{0};
+	std::exception_ptr m_error;
+
+	std::mutex m_stateMutex;
+	std::condition_variable m_workAvailable;
+	std::condition_variable m_allDone;
+
+	// The pool and worker index running on this thread, shared by every pool in the process
+	struct WorkerSlot {
+		const WorkStealingPool* pool = nullptr;
+		int index = -1;
+	};
+
+	static WorkerSlot& currentWorker() {
+		thread_local WorkerSlot slot;
+		return slot;
+	}
+
+	// Index of this pool's worker running on this thread, or -1 for threads outside the pool, including other pools' workers
+	int workerIndex() const {
+		const WorkerSlot& slot = currentWorker();
+		return slot.pool == this ? slot.index : -1;
+	}
+
+	bool popLocal(std::size_t index, std::function<void()>& task) {
+		WorkerQueue& queue = *m_queues[index];
+		std::lock_guard<std::mutex> lock(queue.mutex);
+		if(queue.tasks.empty())
+			return false;
+		task = std::move(queue.tasks.back());
+		queue.tasks.pop_back();
+		m_queued.fetch_sub(1);
+		return true;
+	}
+
+	bool steal(std::size_t thief, std::function<void()>& task) {
+		for(std::size_t offset = 1; offset < m_queues.size(); ++offset) {
+			WorkerQueue& victim = *m_queues[(thief + offset) % m_queues.size()];
+			std::lock_guard<std::mutex> lock(victim.mutex);
+			if(!victim.tasks.empty()) {
+				task = std::move(victim.tasks.front());
+				victim.tasks.pop_front();
+				m_queued.fetch_sub(1);
+				return true;
+			}
+		}
+		return false;
+	}
+
+	void run(std::size_t index) {
+		currentWorker() = WorkerSlot{this, static_cast<int>(index)};
+		TRACE_THREAD_NAME("worker " + std::to_string(index));
+		std::function<void()> task;
+		while(true) {
+			if(popLocal(index, task) || steal(index, task)) {
+				try {
+					task();
+				}
+				catch(...) {
+					std::lock_guard<std::mutex> lock(m_stateMutex);
+					if(!m_error)
+						m_error = std::current_exception();
+				}
+				task = nullptr;
+				if(m_pending.fetch_sub(1) == 1) {
+					std::lock_guard<std::mutex> lock(m_stateMutex);
+					m_allDone.notify_all();
+				}
+				continue;
+			}
+
+			std::unique_lock<std::mutex> lock(m_stateMutex);
+			if(m_stop)
+				return;
+			// submit() raises m_queued under this lock, so a task queued after the failed steal is never missed
+			m_workAvailable.wait(lock, [this] { return m_stop || m_queued.load() > 0; });
+		}
+	}
+
+public:
+	explicit WorkStealingPool(std::size_t threadCount = std::thread::hardware_concurrency()) {
+		threadCount = std::max<std::size_t>(1, threadCount);
+		for(std::size_t i = 0; i < threadCount; ++i)
+			m_queues.push_back(std::make_unique<WorkerQueue>());
+		for(std::size_t i = 0; i < threadCount; ++i)
+			m_threads.emplace_back(&WorkStealingPool::run, this, i);
+	}
+
+	~WorkStealingPool() {
+		{
+			std::lock_guard<std::mutex> lock(m_stateMutex);
+			m_stop = true;
+		}
+		m_workAvailable.notify_all();
+		for(auto& thread : m_threads)
+			thread.join();
+	}
+
+	WorkStealingPool(const WorkStealingPool&) = delete;
+	WorkStealingPool& operator=(const WorkStealingPool&) = delete;
+
+	std::size_t threadCount() const { return m_threads.size(); }
+
+	// Queue a task on the calling worker's own deque, or spread tasks from outside the pool round-robin
+	void submit(std::function<void()> task) {
+		int self = workerIndex();
+		std::size_t index = self >= 0 ? static_cast<std::size_t>(self) : m_nextQueue.fetch_add(1) % m_queues.size();
+		m_pending.fetch_add(1);
+		{
+			std::lock_guard<std::mutex> stateLock(m_stateMutex);
+			std::lock_guard<std::mutex> queueLock(m_queues[index]->mutex);
+			m_queues[index]->tasks.push_back(std::move(task));
+			m_queued.fetch_add(1);
+		}
+		m_workAvailable.notify_one();
+	}
+
+	// Block until every submitted task has finished, rethrowing the first exception a task raised
+	void wait() {
+		TRACE_SPAN("WorkStealingPool::wait", "pool");
+		std::unique_lock<std::mutex> lock(m_stateMutex);
+		m_allDone.wait(lock, [this] { return m_pending.load() == 0; });
+		if(m_error) {
+			std::exception_ptr error = m_error;
+			m_error = nullptr;
+			std::rethrow_exception(error);
+		}
+	}
+
+	// Run body(begin, end) over [first, last) split into chunks of at most grain elements, and wait for completion
+	void parallelFor(std::size_t first, std::size_t last, std::size_t grain, const std::function<void(std::size_t, std::size_t)>& body) {
+		grain = std::max<std::size_t>(1, grain);
+		for(std::size_t begin = first; begin < last; begin += grain) {
+			std::size_t end = std::min(last, begin + grain);
+			submit([&body, begin, end] { body(begin, end); });
+		}
+		wait();
+	}
+};
+
+#endif // THREAD_POOL_HPP
@@ -0,0 +1,216 @@
+// Project-2 - Luca Vicaria - PHYS30762
+// This file defines scoped trace spans written in the Chrome Trace Event format, viewable in chrome://tracing or
+// Perfetto. Each thread appends finished spans to its own buffer, which the tracer keeps after the thread exits,
+// and everything is written out as one JSON file at exit.
+// Spans are compiled in only when PARTICLE_TRACE is defined, and recorded only once a trace file has been set,
+// e.g. "make trace" and then PARTICLE_TRACE_FILE=trace.json ./project-2 --generate 1000000.
+// Last modified 16/10/2026
+
+#ifndef TRACE_HPP
+#define TRACE_HPP
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace trace {
+	// A completed span. Names and categories must be string literals, so recording never copies strings.
+	struct Event {
+		const char* name;
+		const char* category;
+		std::int64_t startNs;    // Since the tracer's epoch
+		std::int64_t durationNs;
+		std::int64_t argument;   // Written as args.value unless NO_ARGUMENT
+	};
+
+	inline constexpr std::int64_t NO_ARGUMENT = INT64_MIN;
+
+	// Per-thread spans are capped so a long run cannot exhaust memory; later spans are counted as dropped
+	inline constexpr std::size_t MAX_EVENTS_PER_THREAD = std::size_t(1) << 20;
+
+	class Tracer {
+	private:
+		struct ThreadBuffer {
+			std::mutex mutex; // Uncontended except while the trace is written
+			std::vector<Event> events;
+			std::string name;
+			std::uint32_t tid;
+			std::size_t dropped = 0;
+		};
+
+		const std::chrono::steady_clock::time_point m_epoch = std::chrono::steady_clock::now();
+		std::atomic<bool> m_enabled{false};
+		std::atomic<std::uint32_t> m_nextTid{1};
+		std::mutex m_mutex;
+		std::vector<std::shared_ptr<ThreadBuffer>> m_buffers;
+
+		// The calling thread's buffer, registered on first use. The tracer shares ownership, so spans recorded by a
+		// thread that has since exited are still written.
+		ThreadBuffer& local() {
+			thread_local std::shared_ptr<ThreadBuffer> buffer;
+			if(!buffer) {
+				buffer = std::make_shared<ThreadBuffer>();
+				buffer->tid = m_nextTid.fetch_add(1);
+				buffer->name = "thread " + std::to_string(buffer->tid);
+				std::lock_guard<std::mutex> lock(m_mutex);
+				m_buffers.push_back(buffer);
+			}
+			return *buffer;
+		}
+
+		static void writeString(std::FILE* file, const std::string& text) {
+			std::fputc('"', file);
+			for(char c : text) {
+				if(c == '"' || c == '\\')
+					std::fputc('\\', file);
+				if(static_cast<unsigned char>(c) >= 0x20)
+					std::fputc(c, file);
+			}
+			std::fputc('"', file);
+		}
+
+	public:
+		static Tracer& instance() {
+			static Tracer tracer;
+			return tracer;
+		}
+
+		bool enabled() const { return m_enabled.load(std::memory_order_relaxed); }
+		void enable() { m_enabled.store(true); }
+
+		std::int64_t now() const {
+			return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - m_epoch).count();
+		}
+
+		void record(const Event& event) {
+			ThreadBuffer& buffer = local();
+			std::lock_guard<std::mutex> lock(buffer.mutex);
+			if(buffer.events.size() < MAX_EVENTS_PER_THREAD)
+				buffer.events.push_back(event);
+			else
+				++buffer.dropped;
+		}
+
+		// Label the calling thread in the viewer, e.g. "main" or "worker 3"
+		void setThreadName(std::string name) {
+			ThreadBuffer& buffer = local();
+			std::lock_guard<std::mutex> lock(buffer.mutex);
+			buffer.name = std::move(name);
+		}
+
+		// Write every recorded span as a Chrome Trace Event JSON file, returning the number of spans written
+		std::size_t write(const std::string& path) {
+			std::unique_ptr<std::FILE, int (*)(std::FILE*)> file(std::fopen(path.c_str(), "w"), &std::fclose);
+			if(!file)
+				throw std::runtime_error("Cannot write trace to '" + path + "'.");
+
+			std::lock_guard<std::mutex> lock(m_mutex);
+			std::size_t written = 0, dropped = 0;
+			bool first = true;
+			std::fputs("{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n", file.get());
+			for(const auto& buffer : m_buffers) {
+				std::lock_guard<std::mutex> bufferLock(buffer->mutex);
+				std::fprintf(file.get(), "%s{\"ph\":\"M\",\"name\":\"thread_name\",\"pid\":1,\"tid\":%u,\"args\":{\"name\":", first ? "" : ",\n", buffer->tid);
+				writeString(file.get(), buffer->name);
+				std::fputs("}}", file.get());
+				first = false;
+
+				// Timestamps are microseconds with nanosecond precision
+				for(const Event& event : buffer->events) {
+					std::fprintf(file.get(), ",\n{\"ph\":\"X\",\"name\":\"%s\",\"cat\":\"%s\",\"pid\":1,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f",
+					             event.name, event.category, buffer->tid, event.startNs / 1e3, event.durationNs / 1e3);
+					if(event.argument != NO_ARGUMENT)
+						std::fprintf(file.get(), ",\"args\":{\"value\":%lld}", static_cast<long long>(event.argument));
+					std::fputc('}', file.get());
+				}
+				written += buffer->events.size();
+				dropped += buffer->dropped;
+			}
+			std::fprintf(file.get(), "\n],\"otherData\":{\"dropped_spans\":%zu}}\n", dropped);
+			return written;
+		}
+	};
+
+	// Records the lifetime of the scope as one span, if the tracer is enabled when the scope starts
+	class Span {
+	private:
+		const char* m_name;
+		const char* m_category;
+		std::int64_t m_argument;
+		std::int64_t m_start;
+
+	public:
+		Span(const char* name, const char* category, std::int64_t argument = NO_ARGUMENT)
+			: m_name(name), m_category(category), m_argument(argument), m_start(Tracer::instance().enabled() ? Tracer::instance().now() : -1) {}
+
+		~Span() {
+			if(m_start >= 0) {
+				Tracer& tracer = Tracer::instance();
+				tracer.record(Event{m_name, m_category, m_start, tracer.now() - m_start, m_argument});
+			}
+		}
+
+		Span(const Span&) = delete;
+		Span& operator=(const Span&) = delete;
+	};
+
+	// Enables tracing for its lifetime and writes the trace file when destroyed, e.g. at the end of main.
+	// A null or empty path leaves tracing disabled.
+	class FlushOnExit {
+	private:
+		std::string m_path;
+
+	public:
+		explicit FlushOnExit(const char* path) : m_path(path ? path : "") {
+			if(!m_path.empty()) {
+				Tracer::instance().setThreadName("main");
+				Tracer::instance().enable();
+			}
+		}
+
+		~FlushOnExit() {
+			if(m_path.empty())
+				return;
+			try {
+				std::size_t spans = Tracer::instance().write(m_path);
+				std::fprintf(stderr, "Wrote %zu trace spans to %s\n", spans, m_path.c_str());
+			}
+			catch(const std::exception& e) {
+				std::fprintf(stderr, "%s\n", e.what());
+			}
+		}
+
+		FlushOnExit(const FlushOnExit&) = delete;
+		FlushOnExit& operator=(const FlushOnExit&) = delete;
+	};
+}
+
+#define TRACE_CONCAT_INNER(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_INNER(a, b)
+
+#if defined(PARTICLE_TRACE)
+// Trace the rest of the enclosing scope as a span with a string literal name and category
+#define TRACE_SPAN(name, category) ::trace::Span TRACE_CONCAT(traceSpan, __LINE__)(name, category)
+// As TRACE_SPAN, with an integer shown as args.value in the viewer
+#define TRACE_SPAN_ARG(name, category, argument) \
+	::trace::Span TRACE_CONCAT(traceSpan, __LINE__)(name, category, static_cast<std::int64_t>(argument))
+#define TRACE_THREAD_NAME(name) \
+	do { if(::trace::Tracer::instance().enabled()) ::trace::Tracer::instance().setThreadName(name); } while(0)
+// Enable tracing if path is a non-empty file name, and write the trace there at the end of the scope
+#define TRACE_FLUSH_ON_EXIT(path) ::trace::FlushOnExit TRACE_CONCAT(traceFlush, __LINE__)(path)
+#else
+#define TRACE_SPAN(name, category) ((void)0)
+#define TRACE_SPAN_ARG(name, category, argument) ((void)0)
+#define TRACE_THREAD_NAME(name) ((void)0)
+#define TRACE_FLUSH_ON_EXIT(path) ((void)0)
+#endif
+
+#endif // TRACE_HPP
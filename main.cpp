@@ -1,7 +1,7 @@
 // Project-2 - Luca Vicaria - PHYS30762
 // This file is the main entry point of the particle simulation project.
 // It initialises particles, sets up the catalogue, and manages the interaction loop.
-// Last modified 08/05/2024
+// Last modified 16/10/2026
 
 #include <iostream>
 #include <vector>
@@ -11,12 +11,26 @@
 #include <limits>
 #include <algorithm>  
 #include <cstdlib> 
+#include <cstdint>
+#include <thread>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <atomic>
+#include <csignal>
 
 #include "particle.hpp"
 #include "leptons.hpp"
 #include "quarks.hpp"
 #include "bosons.hpp"
 #include "four_momentum.hpp"
+#include "event_generator.hpp"
+#include "random_service.hpp"
+#include "particle_catalogue.hpp"
+#include "catalogue_query.hpp"
+#include "catalogue_server.hpp"
+#include "metrics.hpp"
+#include "trace.hpp"
 
 // Function to set the console text colour for output, user input, and reset to default
 #ifdef _WIN32
@@ -58,40 +72,8 @@ void setConsoleColour(unsigned int colour) {
 #endif
 }
 
-// Function to count the number of particles of a given type in the catalogue without using size() method
-int countParticleType(const std::map<std::string, std::unique_ptr<Particle>>& catalogue, const std::string& type) {
-	int count = 0;
-	for(const auto& pair : catalogue) {
-		if(pair.second->getType() == type)
-			++count;
-	}
-	return count;
-}
-
-// Function to create a sub container of particles of a given type in the catalogue
-std::vector<std::shared_ptr<Particle>> getParticlesOfType(const std::map<std::string, std::unique_ptr<Particle>>& catalogue, const std::string& type) {
-	std::vector<std::shared_ptr<Particle>> particles;
-	for(const auto& pair : catalogue) {
-		if(pair.second->getType() == type) {
-			// Temporarily create a shared_ptr from the raw pointer managed by unique_ptr
-			std::shared_ptr<Particle> temp_shared_ptr(pair.second.get(), [](Particle*){});
-			particles.push_back(temp_shared_ptr);
-		}
-	}
-	return particles;
-}
-
-// Function to sum the four-momenta of all particles in the catalogue
-FourMomentum sumFourMomenta(const std::map<std::string, std::unique_ptr<Particle>>& catalogue) {
-	FourMomentum totalMomentum;
-	for(const auto& pair : catalogue) {
-		totalMomentum = totalMomentum + *(pair.second->getFourMomentum());
-	}
-	return totalMomentum;
-}
-
 // Main interactive loop to display particle information and allow user to query specific particles
-void loop(std::map<std::string, std::unique_ptr<Particle>>& particleCatalogue) {
+void loop(const ParticleCatalogue& particleCatalogue) {
 	std::string input;
 	setConsoleColour(1); // Set text colour to green for output
 	std::cout<<"Particle Information Catalogue\n\n";
@@ -100,17 +82,12 @@ void loop(std::map<std::string, std::unique_ptr<Particle>>& particleCatalogue) {
 
 	// find number of leptons/ quarks/ bosons
 	std::cout<<"Number of each particle type:"<<std::endl;
-	auto sub_container_leptons = getParticlesOfType(particleCatalogue, "Lepton");  // shallow copy of the catalogue map into a vector containing only shared pointers to the leptons
-	std::cout<<"Leptons: "<<sub_container_leptons.size()<<std::endl;
-
-	auto sub_container_quarks = getParticlesOfType(particleCatalogue, "Quark");
-	std::cout<<"Quarks: "<<sub_container_quarks.size()<<std::endl;
-
-	auto sub_container_bosons = getParticlesOfType(particleCatalogue, "Boson");
-	std::cout<<"Bosons: "<<sub_container_bosons.size()<<std::endl;
+	std::cout<<"Leptons: "<<particleCatalogue.countCategory(ParticleCategory::Lepton)<<std::endl;
+	std::cout<<"Quarks: "<<particleCatalogue.countCategory(ParticleCategory::Quark)<<std::endl;
+	std::cout<<"Bosons: "<<particleCatalogue.countCategory(ParticleCategory::Boson)<<std::endl;
 
 	// sum of four momenta of all particles in the catalogue
-	FourMomentum totalMomentum = sumFourMomenta(particleCatalogue);
+	FourMomentum totalMomentum = particleCatalogue.totalFourMomentum();
 	std::cout<<"Total four-momentum of all particles: "<<totalMomentum.print_four_momentum()<<std::endl<<'\n';
 
 	std::cout<<"All particle information:\n"<<std::endl;
@@ -118,6 +95,7 @@ void loop(std::map<std::string, std::unique_ptr<Particle>>& particleCatalogue) {
 
 	// Lambda function to print all particles in the catalogue
 	auto printAllParticles = [&particleCatalogue]() {
+		TRACE_SPAN_ARG("print all particles", "print", particleCatalogue.size());
 		for(const auto& pair : particleCatalogue) {
 			pair.second->print();  // Using print() which internally calls getInfo()
 		}
@@ -128,7 +106,7 @@ void loop(std::map<std::string, std::unique_ptr<Particle>>& particleCatalogue) {
 
 	while(true) {
 		setConsoleColour(2); // Set text colour to yellow for user input
-		std::cout<<"\nEnter a particle name to get it's information or 'quit' to exit: ";
+		std::cout<<"\nEnter a particle name, alias (e.g. positron, e+) or PDG ID to get it's information or 'quit' to exit: ";
 		setConsoleColour(0); // Reset to default before reading input to avoid colouring input text
 		std::getline(std::cin, input);
 
@@ -137,11 +115,11 @@ void loop(std::map<std::string, std::unique_ptr<Particle>>& particleCatalogue) {
 		if(input == "quit")
 			break;
 
-		auto it = particleCatalogue.find(input);
+		const Particle* particle = particleCatalogue.resolve(input);
 		setConsoleColour(1); // Set text colour to green for output
-		if(it != particleCatalogue.end()) {
+		if(particle) {
 			std::cout<<std::endl; 
-			it->second->print();
+			particle->print();
 			std::cout<<std::endl;  // Ensure there's a clear separation after the interaction
 		} else {
 			std::cout<<"\nParticle not found. Please try again.\n";
@@ -155,60 +133,62 @@ void loop(std::map<std::string, std::unique_ptr<Particle>>& particleCatalogue) {
 }
 
 // Function to initialize the particle catalogue with all particles in the standard model
-std::map<std::string, std::unique_ptr<Particle>> initialiseParticles() {
-	std::map<std::string, std::unique_ptr<Particle>> particleCatalogue;  // STL map template with string key and unique_ptr value
-
-	particleCatalogue["electron"] = std::make_unique<Electron>(std::make_shared<FourMomentum>(0.511, 0, 0, 0)); // Create an electron with energy 0.511 MeV
-	particleCatalogue["muon"] = std::make_unique<Muon>(std::make_shared<FourMomentum>(105.66, 0, 0, 0)); 
-	particleCatalogue["tau"] = std::make_unique<Tau>(std::make_shared<FourMomentum>(1776.8, 0, 0, 0));   
-	particleCatalogue["electron neutrino"] = std::make_unique<Neutrino>(NeutrinoType::ElectronNeutrino, std::make_shared<FourMomentum>(0, 0, 0, 0), false, false);
-	particleCatalogue["muon neutrino"] = std::make_unique<Neutrino>(NeutrinoType::MuonNeutrino, std::make_shared<FourMomentum>(0, 0, 0, 0), false, false);
-	particleCatalogue["tau neutrino"] = std::make_unique<Neutrino>(NeutrinoType::TauNeutrino, std::make_shared<FourMomentum>(0, 0, 0, 0), false, false);
+ParticleCatalogue initialiseParticles() {
+	TRACE_SPAN("initialiseParticles", "catalogue");
+	ParticleCatalogue particleCatalogue;  // Owns the particles and indexes them by name, category, charge and mass
+
+	particleCatalogue.insert("electron", std::make_unique<Electron>(FourMomentum(0.511, 0, 0, 0))); // Create an electron with energy 0.511 MeV
+	particleCatalogue.insert("muon", std::make_unique<Muon>(FourMomentum(105.66, 0, 0, 0)));
+	particleCatalogue.insert("tau", std::make_unique<Tau>(FourMomentum(1776.8, 0, 0, 0)));
+	particleCatalogue.insert("electron neutrino", std::make_unique<Neutrino>(NeutrinoType::ElectronNeutrino, FourMomentum(0, 0, 0, 0), false, false));
+	particleCatalogue.insert("muon neutrino", std::make_unique<Neutrino>(NeutrinoType::MuonNeutrino, FourMomentum(0, 0, 0, 0), false, false));
+	particleCatalogue.insert("tau neutrino", std::make_unique<Neutrino>(NeutrinoType::TauNeutrino, FourMomentum(0, 0, 0, 0), false, false));
 	
-	particleCatalogue["anti-electron"] = std::make_unique<Electron>(std::make_shared<FourMomentum>(0.511, 0, 0, 0), true);
-	particleCatalogue["anti-muon"] = std::make_unique<Muon>(std::make_shared<FourMomentum>(105.66, 0, 0, 0), true);
-	particleCatalogue["anti-tau"] = std::make_unique<Tau>(std::make_shared<FourMomentum>(1776.8, 0, 0, 0), true);
-	particleCatalogue["anti-electron neutrino"] = std::make_unique<Neutrino>(NeutrinoType::ElectronNeutrino, std::make_shared<FourMomentum>(0, 0, 0, 0), true, false);
-	particleCatalogue["anti-muon neutrino"] = std::make_unique<Neutrino>(NeutrinoType::MuonNeutrino, std::make_shared<FourMomentum>(0, 0, 0, 0), true, false);
-	particleCatalogue["anti-tau neutrino"] = std::make_unique<Neutrino>(NeutrinoType::TauNeutrino, std::make_shared<FourMomentum>(0, 0, 0, 0), true, false);
-
-	particleCatalogue["upquark"] = std::make_unique<Quark>(QuarkType::UpQuark, ColourCharge::Red, std::make_shared<FourMomentum>(2.2, 0, 0, 0));
-	particleCatalogue["downquark"] = std::make_unique<Quark>(QuarkType::DownQuark, ColourCharge::Blue, std::make_shared<FourMomentum>(4.7, 0, 0, 0));
-	particleCatalogue["strangequark"] = std::make_unique<Quark>(QuarkType::StrangeQuark, ColourCharge::Green, std::make_shared<FourMomentum>(96, 0, 0, 0));
-	particleCatalogue["charmquark"] = std::make_unique<Quark>(QuarkType::CharmQuark, ColourCharge::Red, std::make_shared<FourMomentum>(1280, 0, 0, 0));
-	particleCatalogue["topquark"] = std::make_unique<Quark>(QuarkType::TopQuark, ColourCharge::Blue, std::make_shared<FourMomentum>(173100, 0, 0, 0));
-	particleCatalogue["bottomquark"] = std::make_unique<Quark>(QuarkType::BottomQuark, ColourCharge::Green, std::make_shared<FourMomentum>(4180, 0, 0, 0));
-
-	particleCatalogue["anti-upquark"] = std::make_unique<Quark>(QuarkType::UpQuark, ColourCharge::AntiRed, std::make_shared<FourMomentum>(2.2, 0, 0, 0), true);
-	particleCatalogue["anti-downquark"] = std::make_unique<Quark>(QuarkType::DownQuark, ColourCharge::AntiBlue, std::make_shared<FourMomentum>(4.7, 0, 0, 0), true);
-	particleCatalogue["anti-strangequark"] = std::make_unique<Quark>(QuarkType::StrangeQuark, ColourCharge::AntiGreen, std::make_shared<FourMomentum>(96, 0, 0, 0), true);
-	particleCatalogue["anti-charmquark"] = std::make_unique<Quark>(QuarkType::CharmQuark, ColourCharge::AntiRed, std::make_shared<FourMomentum>(1280, 0, 0, 0), true);
-	particleCatalogue["anti-topquark"] = std::make_unique<Quark>(QuarkType::TopQuark, ColourCharge::AntiBlue, std::make_shared<FourMomentum>(173100, 0, 0, 0), true);
-	particleCatalogue["anti-bottomquark"] = std::make_unique<Quark>(QuarkType::BottomQuark, ColourCharge::AntiGreen, std::make_shared<FourMomentum>(4180, 0, 0, 0), true);
-
-	particleCatalogue["photon"] = std::make_unique<Photon>(std::make_shared<FourMomentum>(0, 0, 0, 0));
-	particleCatalogue["Wboson"] = std::make_unique<WBoson>(std::make_shared<FourMomentum>(80360, 0, 0, 0));
-	particleCatalogue["Zboson"] = std::make_unique<ZBoson>(std::make_shared<FourMomentum>(91190, 0, 0, 0));
-	particleCatalogue["gluon"] = std::make_unique<Gluon>(std::make_shared<FourMomentum>(0, 0, 0, 0), ColourCharge::Red, ColourCharge::AntiRed);
-	particleCatalogue["higgs boson"] = std::make_unique<HiggsBoson>(std::make_shared<FourMomentum>(125110, 0, 0, 0));
-
-	particleCatalogue["anti-Wboson"] = std::make_unique<WBoson>(std::make_shared<FourMomentum>(80360, 0, 0, 0), true);  // True specifies it's an antiparticle
-	particleCatalogue["anti-gluon"] = std::make_unique<Gluon>(std::make_shared<FourMomentum>(0, 0, 0, 0), ColourCharge::AntiRed, ColourCharge::Red);  // Swapped colors for antiparticle
+	particleCatalogue.insert("anti-electron", std::make_unique<Electron>(FourMomentum(0.511, 0, 0, 0), true));
+	particleCatalogue.insert("anti-muon", std::make_unique<Muon>(FourMomentum(105.66, 0, 0, 0), true));
+	particleCatalogue.insert("anti-tau", std::make_unique<Tau>(FourMomentum(1776.8, 0, 0, 0), true));
+	particleCatalogue.insert("anti-electron neutrino", std::make_unique<Neutrino>(NeutrinoType::ElectronNeutrino, FourMomentum(0, 0, 0, 0), true, false));
+	particleCatalogue.insert("anti-muon neutrino", std::make_unique<Neutrino>(NeutrinoType::MuonNeutrino, FourMomentum(0, 0, 0, 0), true, false));
+	particleCatalogue.insert("anti-tau neutrino", std::make_unique<Neutrino>(NeutrinoType::TauNeutrino, FourMomentum(0, 0, 0, 0), true, false));
+
+	particleCatalogue.insert("upquark", std::make_unique<Quark>(QuarkType::UpQuark, ColourCharge::Red, FourMomentum(2.2, 0, 0, 0)));
+	particleCatalogue.insert("downquark", std::make_unique<Quark>(QuarkType::DownQuark, ColourCharge::Blue, FourMomentum(4.7, 0, 0, 0)));
+	particleCatalogue.insert("strangequark", std::make_unique<Quark>(QuarkType::StrangeQuark, ColourCharge::Green, FourMomentum(96, 0, 0, 0)));
+	particleCatalogue.insert("charmquark", std::make_unique<Quark>(QuarkType::CharmQuark, ColourCharge::Red, FourMomentum(1280, 0, 0, 0)));
+	particleCatalogue.insert("topquark", std::make_unique<Quark>(QuarkType::TopQuark, ColourCharge::Blue, FourMomentum(173100, 0, 0, 0)));
+	particleCatalogue.insert("bottomquark", std::make_unique<Quark>(QuarkType::BottomQuark, ColourCharge::Green, FourMomentum(4180, 0, 0, 0)));
+
+	particleCatalogue.insert("anti-upquark", std::make_unique<Quark>(QuarkType::UpQuark, ColourCharge::AntiRed, FourMomentum(2.2, 0, 0, 0), true));
+	particleCatalogue.insert("anti-downquark", std::make_unique<Quark>(QuarkType::DownQuark, ColourCharge::AntiBlue, FourMomentum(4.7, 0, 0, 0), true));
+	particleCatalogue.insert("anti-strangequark", std::make_unique<Quark>(QuarkType::StrangeQuark, ColourCharge::AntiGreen, FourMomentum(96, 0, 0, 0), true));
+	particleCatalogue.insert("anti-charmquark", std::make_unique<Quark>(QuarkType::CharmQuark, ColourCharge::AntiRed, FourMomentum(1280, 0, 0, 0), true));
+	particleCatalogue.insert("anti-topquark", std::make_unique<Quark>(QuarkType::TopQuark, ColourCharge::AntiBlue, FourMomentum(173100, 0, 0, 0), true));
+	particleCatalogue.insert("anti-bottomquark", std::make_unique<Quark>(QuarkType::BottomQuark, ColourCharge::AntiGreen, FourMomentum(4180, 0, 0, 0), true));
+
+	particleCatalogue.insert("photon", std::make_unique<Photon>(FourMomentum(0, 0, 0, 0)));
+	particleCatalogue.insert("Wboson", std::make_unique<WBoson>(FourMomentum(80360, 0, 0, 0)));
+	particleCatalogue.insert("Zboson", std::make_unique<ZBoson>(FourMomentum(91190, 0, 0, 0)));
+	particleCatalogue.insert("gluon", std::make_unique<Gluon>(FourMomentum(0, 0, 0, 0), ColourCharge::Red, ColourCharge::AntiRed));
+	particleCatalogue.insert("higgs boson", std::make_unique<HiggsBoson>(FourMomentum(125110, 0, 0, 0)));
+
+	particleCatalogue.insert("anti-Wboson", std::make_unique<WBoson>(FourMomentum(80360, 0, 0, 0), true)); // True specifies it's an antiparticle
+	particleCatalogue.insert("anti-gluon", std::make_unique<Gluon>(FourMomentum(0, 0, 0, 0), ColourCharge::AntiRed, ColourCharge::Red)); // Swapped colors for antiparticle
 	// No antiparticle for Z boson, Higgs boson and photon
 
 	return particleCatalogue;
 }
 
-void createAndPrintParticleDecays(std::map<std::string, std::unique_ptr<Particle>>& particleCatalogue) {
+void createAndPrintParticleDecays(const ParticleCatalogue& particleCatalogue) {
+TRACE_SPAN("createAndPrintParticleDecays", "print");
 
 // create a tau which decays into a lepton, lepton neutrino, and tau neutrino
-auto tau1 = std::make_unique<Tau>(std::make_shared<FourMomentum>(1776.8, 0, 0, 0));
+auto tau1 = std::make_unique<Tau>(FourMomentum(1776.8, 0, 0, 0));
 try {
 // Set a valid set of decay particles
 	tau1->setDecayParticles({
-		std::static_pointer_cast<Particle>(std::make_shared<Electron>(std::make_shared<FourMomentum>(0.511, 0, 0, 0))), 
-		std::static_pointer_cast<Particle>(std::make_shared<Neutrino>(NeutrinoType::ElectronNeutrino, std::make_shared<FourMomentum>(0, 0, 0, 0), true, false)),
-		std::static_pointer_cast<Particle>(std::make_shared<Neutrino>(NeutrinoType::TauNeutrino, std::make_shared<FourMomentum>(0, 0, 0, 0), false, false))
+		std::static_pointer_cast<Particle>(std::make_shared<Electron>(FourMomentum(0.511, 0, 0, 0))), 
+		std::static_pointer_cast<Particle>(std::make_shared<Neutrino>(NeutrinoType::ElectronNeutrino, FourMomentum(0, 0, 0, 0), true, false)),
+		std::static_pointer_cast<Particle>(std::make_shared<Neutrino>(NeutrinoType::TauNeutrino, FourMomentum(0, 0, 0, 0), false, false))
 	});
 
 	// print the tau information
@@ -220,13 +200,13 @@ catch(const std::exception& e) {
 }
 
 // create a tau which decays into two quarks and a tau neutrino
-auto tau2 = std::make_unique<Tau>(std::make_shared<FourMomentum>(1776.8, 0, 0, 0));
+auto tau2 = std::make_unique<Tau>(FourMomentum(1776.8, 0, 0, 0));
 try {
 	// Set a valid set of decay particles
 	tau2->setDecayParticles({
-		std::make_shared<Quark>(QuarkType::UpQuark, ColourCharge::AntiRed, std::make_shared<FourMomentum>(2.2, 0, 0, 0), true),
-		std::make_shared<Quark>(QuarkType::DownQuark, ColourCharge::Blue, std::make_shared<FourMomentum>(4.7, 0, 0, 0)),
-		std::make_shared<Neutrino>(NeutrinoType::TauNeutrino, std::make_shared<FourMomentum>(0, 0, 0, 0), false, false)
+		std::make_shared<Quark>(QuarkType::UpQuark, ColourCharge::AntiRed, FourMomentum(2.2, 0, 0, 0), true),
+		std::make_shared<Quark>(QuarkType::DownQuark, ColourCharge::Blue, FourMomentum(4.7, 0, 0, 0)),
+		std::make_shared<Neutrino>(NeutrinoType::TauNeutrino, FourMomentum(0, 0, 0, 0), false, false)
 	});
 
 	std::cout<<"\nCreating a Tau which decays into two quarks and a tau neutrino and printing it's information:"<<std::endl;
@@ -237,12 +217,12 @@ catch(const std::exception& e) {
 }
 
 // Create a W boson which decays into a quark and an anti-quark
-auto wboson1 = std::make_unique<WBoson>(std::make_shared<FourMomentum>(80360, 0, 0, 0));
+auto wboson1 = std::make_unique<WBoson>(FourMomentum(80360, 0, 0, 0));
 try {
 	// Set an valid set of decay particles
 	wboson1->setDecayParticles({
-		std::static_pointer_cast<Particle>(std::make_shared<Quark>(QuarkType::UpQuark, ColourCharge::Red, std::make_shared<FourMomentum>(2.2, 0, 0, 0))),
-		std::static_pointer_cast<Particle>(std::make_shared<Quark>(QuarkType::DownQuark, ColourCharge::Blue, std::make_shared<FourMomentum>(4.7, 0, 0, 0), true)),
+		std::static_pointer_cast<Particle>(std::make_shared<Quark>(QuarkType::UpQuark, ColourCharge::Red, FourMomentum(2.2, 0, 0, 0))),
+		std::static_pointer_cast<Particle>(std::make_shared<Quark>(QuarkType::DownQuark, ColourCharge::Blue, FourMomentum(4.7, 0, 0, 0), true)),
 	});
 
 	std::cout<<"\nCreating a W Boson which decays into a quark and an anti-quark and printing it's information:"<<std::endl;
@@ -253,12 +233,12 @@ catch(const std::exception& e) {
 }
 
 // Create a W boson which decays into a lepton and a neutrino
-auto wboson2 = std::make_unique<WBoson>(std::make_shared<FourMomentum>(80360, 0, 0, 0));
+auto wboson2 = std::make_unique<WBoson>(FourMomentum(80360, 0, 0, 0));
 try {
 	// Set an valid set of decay particles
 	wboson2->setDecayParticles({
-		std::static_pointer_cast<Particle>(std::make_shared<Electron>(std::make_shared<FourMomentum>(0.511, 0, 0, 0), true)), 
-		std::static_pointer_cast<Particle>(std::make_shared<Neutrino>(NeutrinoType::ElectronNeutrino, std::make_shared<FourMomentum>(0, 0, 0, 0), false, false)),
+		std::static_pointer_cast<Particle>(std::make_shared<Electron>(FourMomentum(0.511, 0, 0, 0), true)), 
+		std::static_pointer_cast<Particle>(std::make_shared<Neutrino>(NeutrinoType::ElectronNeutrino, FourMomentum(0, 0, 0, 0), false, false)),
 	});
 
 	std::cout<<"\nCreating a W Boson which decays into a lepton and a neutrino and printing it's information:"<<std::endl;
@@ -269,12 +249,12 @@ catch(const std::exception& e) {
 }
 
 // Create a Z boson which decays into a quark and an anti-quark
-auto zboson1 = std::make_unique<ZBoson>(std::make_shared<FourMomentum>(80360, 0, 0, 0));
+auto zboson1 = std::make_unique<ZBoson>(FourMomentum(80360, 0, 0, 0));
 try {
 	// Set an valid set of decay particles
 	zboson1->setDecayParticles({
-		std::static_pointer_cast<Particle>(std::make_shared<Quark>(QuarkType::UpQuark, ColourCharge::Red, std::make_shared<FourMomentum>(2.2, 0, 0, 0))),
-		std::static_pointer_cast<Particle>(std::make_shared<Quark>(QuarkType::UpQuark, ColourCharge::AntiRed, std::make_shared<FourMomentum>(4.7, 0, 0, 0), true)),
+		std::static_pointer_cast<Particle>(std::make_shared<Quark>(QuarkType::UpQuark, ColourCharge::Red, FourMomentum(2.2, 0, 0, 0))),
+		std::static_pointer_cast<Particle>(std::make_shared<Quark>(QuarkType::UpQuark, ColourCharge::AntiRed, FourMomentum(4.7, 0, 0, 0), true)),
 	});
 
 	std::cout<<"\nCreating a Z Boson which decays into a quark and an anti-quark and printing it's information:"<<std::endl;
@@ -285,12 +265,12 @@ catch(const std::exception& e) {
 }
 
 // Create a Z boson which decays into a lepton and an anti-lepton
-auto zboson2 = std::make_unique<ZBoson>(std::make_shared<FourMomentum>(80360, 0, 0, 0));
+auto zboson2 = std::make_unique<ZBoson>(FourMomentum(80360, 0, 0, 0));
 try {
 	// Set an valid set of decay particles
 	zboson2->setDecayParticles({
-		std::static_pointer_cast<Particle>(std::make_shared<Electron>(std::make_shared<FourMomentum>(0.511, 0, 0, 0))),
-		std::static_pointer_cast<Particle>(std::make_shared<Electron>(std::make_shared<FourMomentum>(0.511, 0, 0, 0), true)),
+		std::static_pointer_cast<Particle>(std::make_shared<Electron>(FourMomentum(0.511, 0, 0, 0))),
+		std::static_pointer_cast<Particle>(std::make_shared<Electron>(FourMomentum(0.511, 0, 0, 0), true)),
 	});
 
 	std::cout<<"\nCreating a Z Boson which decays into a lepton and an anti-lepton and printing it's information:"<<std::endl;
@@ -301,12 +281,12 @@ catch(const std::exception& e) {
 }
 
 // // Create a Higgs boson which decays into two Z bosons
-auto higgsboson1 = std::make_unique<HiggsBoson>(std::make_shared<FourMomentum>(125110, 0, 0, 0));
+auto higgsboson1 = std::make_unique<HiggsBoson>(FourMomentum(125110, 0, 0, 0));
 try {
 	// Set an valid set of decay particles
 	higgsboson1->setDecayParticles({
-		std::static_pointer_cast<Particle>(std::make_shared<ZBoson>(std::make_shared<FourMomentum>(91190, 0, 0, 0))),
-		std::static_pointer_cast<Particle>(std::make_shared<ZBoson>(std::make_shared<FourMomentum>(91190, 0, 0, 0))),
+		std::static_pointer_cast<Particle>(std::make_shared<ZBoson>(FourMomentum(91190, 0, 0, 0))),
+		std::static_pointer_cast<Particle>(std::make_shared<ZBoson>(FourMomentum(91190, 0, 0, 0))),
 	});
 
 	std::cout<<"\nCreating a higgs Boson which decays into two Z bosons and printing it's information:"<<std::endl;
@@ -317,12 +297,12 @@ catch(const std::exception& e) {
 }
 
 // Create a Higgs boson which decays into two W bosons of opposite signs
-auto higgsboson2 = std::make_unique<HiggsBoson>(std::make_shared<FourMomentum>(125110, 0, 0, 0));
+auto higgsboson2 = std::make_unique<HiggsBoson>(FourMomentum(125110, 0, 0, 0));
 try {
 	// Set an valid set of decay particles
 	higgsboson2->setDecayParticles({
-		std::static_pointer_cast<Particle>(std::make_shared<WBoson>(std::make_shared<FourMomentum>(80360, 0, 0, 0))),
-		std::static_pointer_cast<Particle>(std::make_shared<WBoson>(std::make_shared<FourMomentum>(80360, 0, 0, 0), true)),
+		std::static_pointer_cast<Particle>(std::make_shared<WBoson>(FourMomentum(80360, 0, 0, 0))),
+		std::static_pointer_cast<Particle>(std::make_shared<WBoson>(FourMomentum(80360, 0, 0, 0), true)),
 	});
 
 	std::cout<<"\nCreating a higgs Boson which decays into two W bosons of opposite signs and printing it's information:"<<std::endl;
@@ -333,12 +313,12 @@ catch(const std::exception& e) {
 }
 
 // Create a Higgs boson which decays into two photons
-auto higgsboson3 = std::make_unique<HiggsBoson>(std::make_shared<FourMomentum>(125110, 0, 0, 0));
+auto higgsboson3 = std::make_unique<HiggsBoson>(FourMomentum(125110, 0, 0, 0));
 try {
 	// Set an valid set of decay particles
 	higgsboson3->setDecayParticles({
-		std::static_pointer_cast<Particle>(std::make_shared<Photon>(std::make_shared<FourMomentum>(0, 0, 0, 0))),
-		std::static_pointer_cast<Particle>(std::make_shared<Photon>(std::make_shared<FourMomentum>(0, 0, 0, 0))),
+		std::static_pointer_cast<Particle>(std::make_shared<Photon>(FourMomentum(0, 0, 0, 0))),
+		std::static_pointer_cast<Particle>(std::make_shared<Photon>(FourMomentum(0, 0, 0, 0))),
 	});
 
 	std::cout<<"\nCreating a higgs Boson which decays into two photons and printing it's information:"<<std::endl;
@@ -349,12 +329,12 @@ catch(const std::exception& e) {
 }
 
 // Create a Higgs boson which decays into a b quark and an b antiquark
-auto higgsboson4 = std::make_unique<HiggsBoson>(std::make_shared<FourMomentum>(125110, 0, 0, 0));
+auto higgsboson4 = std::make_unique<HiggsBoson>(FourMomentum(125110, 0, 0, 0));
 try {
 	// Set an valid set of decay particles
 	higgsboson4->setDecayParticles({
-		std::static_pointer_cast<Particle>(std::make_shared<Quark>(QuarkType::BottomQuark, ColourCharge::Green, std::make_shared<FourMomentum>(4180, 0, 0, 0))),
-		std::static_pointer_cast<Particle>(std::make_shared<Quark>(QuarkType::BottomQuark, ColourCharge::AntiGreen, std::make_shared<FourMomentum>(4180, 0, 0, 0), true)),
+		std::static_pointer_cast<Particle>(std::make_shared<Quark>(QuarkType::BottomQuark, ColourCharge::Green, FourMomentum(4180, 0, 0, 0))),
+		std::static_pointer_cast<Particle>(std::make_shared<Quark>(QuarkType::BottomQuark, ColourCharge::AntiGreen, FourMomentum(4180, 0, 0, 0), true)),
 	});
 
 	std::cout<<"\nCreating a higgs Boson which decays into a b quark and an b antiquark and printing it's information:"<<std::endl;
@@ -365,19 +345,19 @@ catch(const std::exception& e) {
 }
 
 // Example of handling an invalid set of decay particles for a Tau
-auto tau = std::make_unique<Tau>(std::make_shared<FourMomentum>(1776.8, 0, 0, 0));
+auto tau = std::make_unique<Tau>(FourMomentum(1776.8, 0, 0, 0));
 try {
-	tau->setDecayParticles({std::static_pointer_cast<Particle>(std::make_shared<Neutrino>(NeutrinoType::MuonNeutrino, std::make_shared<FourMomentum>(0.511, 0, 0, 0), true, true))});
+	tau->setDecayParticles({std::static_pointer_cast<Particle>(std::make_shared<Neutrino>(NeutrinoType::MuonNeutrino, FourMomentum(0.511, 0, 0, 0), true, true))});
 } 
 catch (const std::exception& e) {
   std::cerr<<"Handled Exception: "<<e.what()<<'\n';
 }
 
 // Example of handling a particle with an invalid four-momentum
-auto fm = std::make_shared<FourMomentum>(50, 0, 0, 0); // Invalid energy
+auto fm = FourMomentum(50, 0, 0, 0); // Invalid energy
 auto electron = std::make_unique<Electron>(fm);
 
-auto valid = fm->validate(); // Call validate() on the FourMomentum object itself
+auto valid = electron->getFourMomentum().validate(); // Validate the electron's own copy, which carries its rest mass
 if(valid) {
 	std::cout<<"Four-momentum is valid."<<std::endl;
 }
@@ -385,11 +365,164 @@ else
   std::cerr<<"Four-momentum is invalid. \n"<<std::endl;
 
 // show functionality of converting particle to anti-particle
-auto positron = particleCatalogue["electron"]->getAntiParticle(); 
+auto positron = particleCatalogue.at("electron").getAntiParticle(); 
  }
 
+// Generate decay events in parallel and report the throughput, e.g. "--generate 1000000 --threads 8 --seed 42"
+int runGenerator(int argc, char* argv[]) {
+	std::size_t events = 0;
+	std::size_t threads = std::thread::hardware_concurrency();
+
+	for(int i = 1; i + 1 < argc; i += 2) {
+		std::string option = argv[i];
+		if(option == "--generate")
+			events = std::stoull(argv[i + 1]);
+		else if(option == "--threads")
+			threads = std::stoull(argv[i + 1]);
+		else if(option == "--seed")
+			RandomService::setGlobalSeed(std::stoull(argv[i + 1]));
+		else {
+			std::cerr<<"Unknown option: "<<option<<'\n';
+			return 1;
+		}
+	}
+
+	EventGenerator generator(threads);
+	GeneratorReport report = generator.run(events);
+
+	std::cout<<"Generated "<<report.events<<" events on "<<report.threads<<" threads in "<<report.seconds<<" s ("
+	         <<report.eventsPerSecond<<" events/s)\n"
+	         <<"Tau: "<<report.eventsOfKind[0]<<", W: "<<report.eventsOfKind[1]
+	         <<", Z: "<<report.eventsOfKind[2]<<", Higgs: "<<report.eventsOfKind[3]<<'\n'
+	         <<"Charge violations: "<<report.chargeViolations<<'\n'
+	         <<"Checksum: "<<std::hex<<report.checksum<<std::dec<<std::endl;
+	return 0;
+}
+
+// Answer catalogue queries from a file or standard input, e.g. "--batch queries.txt --format csv".
+// Results go to standard output; the query rate is reported on standard error.
+int runBatch(int argc, char* argv[]) {
+	std::string inputPath;
+	QueryFormat format = QueryFormat::JsonLines;
+
+	for(int i = 2; i < argc; ++i) {
+		std::string option = argv[i];
+		if(option == "--format" && i + 1 < argc)
+			format = parseQueryFormat(argv[++i]);
+		else if((option == "-" || option[0] != '-') && inputPath.empty() && i == 2)
+			inputPath = option;
+		else {
+			std::cerr<<"Unknown option: "<<option<<'\n';
+			return 1;
+		}
+	}
+
+	std::ifstream file;
+	if(!inputPath.empty() && inputPath != "-") {
+		file.open(inputPath);
+		if(!file)
+			throw std::runtime_error("Cannot open query file '" + inputPath + "'.");
+	}
+	std::istream& input = file.is_open() ? static_cast<std::istream&>(file) : std::cin;
+	std::ios::sync_with_stdio(false);
+
+	const auto catalogue = initialiseParticles();
+	QueryWriter writer(format, stdout);
+	writer.writeHeader();
+
+	std::size_t queries = 0;
+	std::string line;
+	const auto start = std::chrono::steady_clock::now();
+	TRACE_SPAN("answer queries", "query");
+	while(std::getline(input, line)) {
+		if(CatalogueQuery::answer(catalogue, line, writer))
+			++queries;
+	}
+	writer.flush();
+	std::fflush(stdout);
+	const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+	std::cerr<<"Answered "<<queries<<" queries in "<<elapsed.count()<<" s ("
+	         <<(elapsed.count() > 0.0 ? queries / elapsed.count() : 0.0)<<" queries/s)\n";
+	return 0;
+}
+
+#ifndef _WIN32
+// Server being run by runServer, stopped by SIGINT or SIGTERM
+std::atomic<CatalogueServer*> activeServer{nullptr};
+
+void stopActiveServer(int) {
+	CatalogueServer* server = activeServer.load();
+	if(server)
+		server->stop();
+}
+
+// Serve catalogue queries over a Unix domain socket until interrupted, e.g. "--serve /tmp/catalogue.sock"
+int runServer(int argc, char* argv[]) {
+	if(argc != 3) {
+		std::cerr<<"Usage: "<<argv[0]<<" --serve <socket path>\n";
+		return 1;
+	}
+
+	CatalogueServer server(argv[2], initialiseParticles);
+	activeServer.store(&server);
+	std::signal(SIGINT, stopActiveServer);
+	std::signal(SIGTERM, stopActiveServer);
+
+	std::cerr<<"Serving the particle catalogue on "<<argv[2]<<'\n';
+	server.run();
+	activeServer.store(nullptr);
+	std::cerr<<"Answered "<<server.requests()<<" requests ("<<server.cacheHits()<<" cache hits)\n";
+	return 0;
+}
+
+// Send queries to a running server, from the remaining arguments or else one per line of standard input,
+// e.g. "--query /tmp/catalogue.sock 'LOOKUP positron' 'COUNT lepton'"
+int runClient(int argc, char* argv[]) {
+	if(argc < 3) {
+		std::cerr<<"Usage: "<<argv[0]<<" --query <socket path> [query...]\n";
+		return 1;
+	}
+
+	CatalogueClient client(argv[2]);
+	if(argc > 3) {
+		for(int i = 3; i < argc; ++i)
+			std::cout<<client.query(argv[i]);
+	}
+	else {
+		std::string line;
+		while(std::getline(std::cin, line))
+			std::cout<<client.query(line);
+	}
+	std::cout.flush();
+	return 0;
+}
+#endif
+
 // Main function
-int main() {
+int main(int argc, char* argv[]) {
+	// Write the runtime metrics as JSON on exit if PARTICLE_METRICS_FILE is set
+	metrics::DumpOnExit metricsDump(std::getenv("PARTICLE_METRICS_FILE"));
+	// Write a Chrome trace on exit if built with PARTICLE_TRACE and PARTICLE_TRACE_FILE is set
+	TRACE_FLUSH_ON_EXIT(std::getenv("PARTICLE_TRACE_FILE"));
+
+	try {
+		if(argc > 1 && std::string(argv[1]) == "--generate")
+			return runGenerator(argc, argv);
+		if(argc > 1 && std::string(argv[1]) == "--batch")
+			return runBatch(argc, argv);
+#ifndef _WIN32
+		if(argc > 1 && std::string(argv[1]) == "--serve")
+			return runServer(argc, argv);
+		if(argc > 1 && std::string(argv[1]) == "--query")
+			return runClient(argc, argv);
+#endif
+	}
+	catch(const std::exception& e) {
+		std::cerr<<"Error: "<<e.what()<<'\n';
+		return 1;
+	}
+
 	// Clear the console screen
 	#ifdef _WIN32
 	system("cls");